@@ -6,8 +6,1474 @@
 #include <SFML/Graphics.hpp> // Include the SFML graphics module for window and drawing operations
 #include <vector>            // Include the vector container for storing shapes
 #include <cmath>             // Include cmath for mathematical functions like sin and cos
+#include <SFML/OpenGL.hpp>   // For glFinish, so frame timings include the GPU's work
+#include <chrono>            // For timing frames in the benchmarks
+#include <iostream>          // For printing benchmark results
+#include <string>            // For command-line arguments
+#include <utility>           // For std::move
+#include <algorithm>         // For std::fill, std::sort, std::max
+#include <cstdint>           // For std::uint32_t pixels
+#include <cstdlib>           // For std::abs, std::atoi, std::getenv
+#include <climits>           // For INT_MIN / INT_MAX
+#include <memory>            // For std::unique_ptr backends
+#include <functional>        // For std::function tasks in the worker pool
+#include <thread>            // For the worker pool's threads
+#include <mutex>             // For the worker pool's job hand-off
+#include <condition_variable> // For waking workers and waiting for them
+#include <atomic>            // For handing out tasks without a lock
+#include <new>               // For std::bad_alloc in the counting operator new
+#include <ctime>             // For std::clock, the process's CPU time
+#include <fstream>           // For saving frame timings as CSV
+#if defined(__AVX2__)
+#include <immintrin.h>       // For the AVX2 ray-generation and line-stepping kernels
+#endif
+
+// --- Generating the Starburst Pattern ---
+// This is where the algorithm for creating the pattern comes in.
+// A starburst is stored as pairs of vertices, one pair per ray; drawn as sf::Lines,
+// each pair becomes one line from the center outwards. The writers below fill
+// 2 * numberOfRays vertices starting at 'out'.
+
+// writeStarburstReference: the straightforward version, one std::cos and one
+// std::sin call per ray.
+void writeStarburstReference(sf::Vertex* out, sf::Vector2f center, int numberOfRays, float rayLength) {
+    // We'll use a loop to draw each ray.
+    for (int i = 0; i < numberOfRays; ++i) {
+        // Calculate the angle for the current ray.
+        // We divide the full circle (2 * PI radians) by the number of rays
+        // to get the angular separation between each ray.
+        float angle = static_cast<float>(i) * (2.0f * M_PI) / static_cast<float>(numberOfRays);
+
+        // Calculate the end point of the ray using trigonometry (cosine for x, sine for y).
+        // sf::Vector2f is useful here as it has x and y components.
+        sf::Vector2f rayEndPoint;
+        rayEndPoint.x = center.x + rayLength * std::cos(angle); // x = center.x + length * cos(angle)
+        rayEndPoint.y = center.y + rayLength * std::sin(angle); // y = center.y + length * sin(angle)
+
+        // Two vertices define a line: the center, and the end point calculated above.
+        // sf::Vertex requires a position and an optional color.
+        out[2 * i] = sf::Vertex(center, sf::Color::White);
+        out[2 * i + 1] = sf::Vertex(rayEndPoint, sf::Color::White);
+    }
+}
+
+// writeStarburst: the same rays without calling std::cos/std::sin per ray.
+// The rays are evenly spaced, so each ray's direction is the previous one rotated
+// by the same small angle:
+//     cos(a + d) = cos(a) cos(d) - sin(a) sin(d)
+//     sin(a + d) = sin(a) cos(d) + cos(a) sin(d)
+// That is 4 multiplies and 2 adds per ray instead of two libm calls. We keep 8 rays
+// in flight (8 float lanes: one AVX2 register, or a loop the compiler vectorizes
+// for SSE/NEON), each rotated by 8 steps at a time.
+//
+// Every rotation adds a little float rounding error, so after 'ReseedBlocks'
+// blocks the lanes are recomputed exactly (in double precision). That bounds the
+// error of each direction to about 1e-5, i.e. well under 1/100 of a pixel for a
+// 200-pixel ray; --bench sincos measures it against libm.
+//
+// firstRay and lastRay limit the writing to rays [firstRay, lastRay) (lastRay -1
+// means all of them); ray i still goes to out[2 * i]. Reseeding happens at
+// multiples of 512 rays, plus at firstRay.
+void writeStarburst(sf::Vertex* out, sf::Vector2f center, int numberOfRays, float rayLength, int firstRay = 0,
+                    int lastRay = -1) {
+    constexpr int Lanes = 8;
+    constexpr int ReseedBlocks = 64; // Exact recomputation every 512 rays.
+    if (lastRay < 0) {
+        lastRay = numberOfRays;
+    }
+    const double step = 2.0 * M_PI / numberOfRays;
+    const float rotateCos = static_cast<float>(std::cos(step * Lanes));
+    const float rotateSin = static_cast<float>(std::sin(step * Lanes));
+    const sf::Vertex centerVertex(center, sf::Color::White);
+
+    for (int chunk = firstRay, chunkEnd = 0; chunk < lastRay; chunk = chunkEnd) {
+        chunkEnd = std::min(lastRay, (chunk / (Lanes * ReseedBlocks) + 1) * (Lanes * ReseedBlocks));
+        alignas(32) float cosines[Lanes], sines[Lanes];
+        for (int k = 0; k < Lanes; ++k) {
+            cosines[k] = static_cast<float>(std::cos(step * (chunk + k)));
+            sines[k] = static_cast<float>(std::sin(step * (chunk + k)));
+        }
+        alignas(32) float xs[Lanes], ys[Lanes];
+#if defined(__AVX2__)
+        __m256 c = _mm256_load_ps(cosines), s = _mm256_load_ps(sines);
+        const __m256 rc = _mm256_set1_ps(rotateCos), rs = _mm256_set1_ps(rotateSin);
+        const __m256 cx = _mm256_set1_ps(center.x), cy = _mm256_set1_ps(center.y), length = _mm256_set1_ps(rayLength);
+#endif
+        for (int block = chunk; block < chunkEnd; block += Lanes) {
+#if defined(__AVX2__)
+            _mm256_store_ps(xs, _mm256_add_ps(cx, _mm256_mul_ps(length, c)));
+            _mm256_store_ps(ys, _mm256_add_ps(cy, _mm256_mul_ps(length, s)));
+            const __m256 nextC = _mm256_sub_ps(_mm256_mul_ps(c, rc), _mm256_mul_ps(s, rs));
+            s = _mm256_add_ps(_mm256_mul_ps(s, rc), _mm256_mul_ps(c, rs));
+            c = nextC;
+#else
+            for (int k = 0; k < Lanes; ++k) {
+                xs[k] = center.x + rayLength * cosines[k];
+                ys[k] = center.y + rayLength * sines[k];
+                const float nextC = cosines[k] * rotateCos - sines[k] * rotateSin;
+                sines[k] = sines[k] * rotateCos + cosines[k] * rotateSin;
+                cosines[k] = nextC;
+            }
+#endif
+            const int count = std::min(Lanes, chunkEnd - block);
+            for (int k = 0; k < count; ++k) {
+                out[2 * (block + k)] = centerVertex;
+                out[2 * (block + k) + 1] = sf::Vertex(sf::Vector2f(xs[k], ys[k]), sf::Color::White);
+            }
+        }
+    }
+}
+
+// generateStarburst: a new vector holding the starburst's vertices.
+std::vector<sf::Vertex> generateStarburst(sf::Vector2f center, int numberOfRays, float rayLength) {
+    std::vector<sf::Vertex> starburstVertices(2 * static_cast<std::size_t>(numberOfRays));
+    writeStarburst(starburstVertices.data(), center, numberOfRays, rayLength);
+    return starburstVertices;
+}
+
+// --- Worker Pool ---
+// A fixed set of threads that run the pieces of one job in parallel. run(tasks, f)
+// calls f(0) ... f(tasks - 1), spread over the workers and the calling thread,
+// and returns when all of them have finished. Threads are created once, so
+// handing out a job costs a wake-up rather than a thread start.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads = std::thread::hardware_concurrency()) {
+        for (unsigned i = 1; i < std::max(1u, threads); ++i) { // The caller is the first thread.
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    void run(std::size_t tasks, const std::function<void(std::size_t)>& task) {
+        if (workers.empty() || tasks <= 1) {
+            for (std::size_t i = 0; i < tasks; ++i) {
+                task(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &task;
+            taskCount = tasks;
+            nextTask.store(0);
+            finished = 0;
+            ++generation;
+        }
+        wake.notify_all();
+        std::size_t done = claimTasks(task);
+        std::unique_lock<std::mutex> lock(mutex);
+        finished += done;
+        // Every task has run once 'finished' reaches taskCount, but a worker may
+        // still be between its last claim and reporting back. 'task' is destroyed
+        // when we return, and the next run() reuses nextTask, so wait for it too.
+        allDone.wait(lock, [&] { return finished == taskCount && active == 0; });
+        job = nullptr;
+    }
+
+private:
+    // claimTasks: runs tasks until none are left; returns how many it ran.
+    std::size_t claimTasks(const std::function<void(std::size_t)>& task) {
+        std::size_t done = 0;
+        for (std::size_t i = nextTask.fetch_add(1); i < taskCount; i = nextTask.fetch_add(1)) {
+            task(i);
+            ++done;
+        }
+        return done;
+    }
+
+    void work() {
+        std::uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(std::size_t)>* current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                if (job == nullptr) {
+                    continue; // Woke after that job had already finished.
+                }
+                current = job;
+                ++active;
+            }
+            std::size_t done = claimTasks(*current);
+            std::lock_guard<std::mutex> lock(mutex);
+            finished += done;
+            --active;
+            if (finished == taskCount && active == 0) {
+                allDone.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, allDone;
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::size_t taskCount = 0;
+    std::atomic<std::size_t> nextTask{0};
+    std::size_t finished = 0;
+    unsigned active = 0; // Workers inside claimTasks for the current job.
+    std::uint64_t generation = 0;
+    bool stopping = false;
+};
+
+// --- Pattern Engine ---
+// The starburst is one of several patterns built from line segments (vertex pairs
+// drawn as sf::Lines). Each generator is a pair of functions: segmentCount says
+// exactly how many segments a pattern has for some settings, and writeSegments
+// writes segments [first, last) into the array at 'out' (segment i goes to
+// out[2 * i] and out[2 * i + 1]). The caller owns the memory, sized once up
+// front, so generating never reallocates and the same storage can be refilled
+// every frame. Any range can be written on its own, without the segments before
+// it, which lets writePattern split a big pattern over several threads.
+//
+// All patterns share one PatternSettings; each generator reads 'count' and
+// 'detail' in its own way (see 'parameters' in the table below).
+struct PatternSettings {
+    sf::Vector2f center = sf::Vector2f(400.0f, 300.0f);
+    float size = 200.0f; // Radius of the pattern, in pixels.
+    int count = 36;      // Rays, segments, or polygons per grid row.
+    int detail = 5;      // Turns, petals, frequency, polygon sides, or recursion depth.
+};
+
+// writeCurve: segment i joins pointAt(i / segments) and pointAt((i + 1) / segments),
+// for i in [first, last). Each point is computed once and shared by the two
+// segments that meet there.
+template<typename PointAt>
+void writeCurve(sf::Vertex* out, std::size_t segments, std::size_t first, std::size_t last, PointAt pointAt) {
+    sf::Vector2f previous = pointAt(static_cast<double>(first) / segments);
+    for (std::size_t i = first; i < last; ++i) {
+        const sf::Vector2f next = pointAt(static_cast<double>(i + 1) / segments);
+        out[2 * i] = sf::Vertex(previous, sf::Color::White);
+        out[2 * i + 1] = sf::Vertex(next, sf::Color::White);
+        previous = next;
+    }
+}
+
+// Points on a circle of 'radius' around 'center', at 'angle' radians.
+sf::Vector2f polar(sf::Vector2f center, double radius, double angle) {
+    return sf::Vector2f(center.x + static_cast<float>(radius * std::cos(angle)),
+                        center.y + static_cast<float>(radius * std::sin(angle)));
+}
+
+// Starburst: 'count' rays from the center. Curves: 'count' segments.
+std::size_t countSegments(const PatternSettings& s) { return static_cast<std::size_t>(std::max(1, s.count)); }
+void writeStarburstPattern(sf::Vertex* out, const PatternSettings& s, std::size_t first, std::size_t last) {
+    writeStarburst(out, s.center, std::max(1, s.count), s.size, static_cast<int>(first), static_cast<int>(last));
+}
+
+// Spiral: an Archimedean spiral (radius grows evenly with the angle) of 'detail'
+// turns, drawn with 'count' segments.
+void writeSpiral(sf::Vertex* out, const PatternSettings& s, std::size_t first, std::size_t last) {
+    const double turns = std::max(1, s.detail);
+    writeCurve(out, countSegments(s), first, last,
+               [&](double t) { return polar(s.center, s.size * t, 2.0 * M_PI * turns * t); });
+}
+
+// Rose: r = size * cos(k * angle) with k = 'detail', which has k petals for odd k
+// and 2k for even k.
+void writeRose(sf::Vertex* out, const PatternSettings& s, std::size_t first, std::size_t last) {
+    const double k = std::max(1, s.detail);
+    writeCurve(out, countSegments(s), first, last, [&](double t) {
+        const double angle = 2.0 * M_PI * t;
+        return polar(s.center, s.size * std::cos(k * angle), angle);
+    });
+}
+
+// Lissajous: x and y are sine waves with frequencies 'detail' and 'detail' + 1.
+void writeLissajous(sf::Vertex* out, const PatternSettings& s, std::size_t first, std::size_t last) {
+    const double a = std::max(1, s.detail), b = a + 1.0;
+    writeCurve(out, countSegments(s), first, last, [&](double t) {
+        const double angle = 2.0 * M_PI * t;
+        return sf::Vector2f(s.center.x + static_cast<float>(s.size * std::sin(a * angle + M_PI / 2.0)),
+                            s.center.y + static_cast<float>(s.size * std::sin(b * angle)));
+    });
+}
+
+// Polygon grid: 'count' x 'count' regular polygons with 'detail' sides (at least
+// 3), filling the square of half-width 'size' around the center.
+std::size_t polygonGridSegments(const PatternSettings& s) {
+    const std::size_t cells = static_cast<std::size_t>(std::max(1, s.count));
+    const std::size_t sides = static_cast<std::size_t>(std::max(3, s.detail));
+    if (cells * cells > SIZE_MAX / sides) {
+        return SIZE_MAX; // Saturate rather than wrap, so patternFits still refuses it.
+    }
+    return cells * cells * sides;
+}
+void writePolygonGrid(sf::Vertex* out, const PatternSettings& s, std::size_t first, std::size_t last) {
+    const std::size_t cells = static_cast<std::size_t>(std::max(1, s.count));
+    const std::size_t sides = static_cast<std::size_t>(std::max(3, s.detail));
+    const float cell = 2.0f * s.size / cells;
+    const sf::Vector2f origin(s.center.x - s.size + cell / 2.0f, s.center.y - s.size + cell / 2.0f);
+    auto middle = [&](std::size_t polygon) {
+        return sf::Vector2f(origin.x + (polygon % cells) * cell, origin.y + (polygon / cells) * cell);
+    };
+    auto corner = [&](std::size_t polygon, std::size_t side) {
+        return polar(middle(polygon), 0.45 * cell, 2.0 * M_PI * side / sides - M_PI / 2.0);
+    };
+    // The first polygon's worth of segments is computed with cos/sin; every later
+    // segment is a copy of the same side one polygon earlier, moved to its own cell.
+    std::size_t polygon = first / sides, side = first % sides;
+    for (std::size_t i = first; i < last; ++i) {
+        if (i < first + sides) {
+            out[2 * i] = sf::Vertex(corner(polygon, side), sf::Color::White);
+            out[2 * i + 1] = sf::Vertex(corner(polygon, side + 1), sf::Color::White);
+        } else {
+            const sf::Vector2f offset = middle(polygon) - middle(polygon - 1);
+            out[2 * i] = sf::Vertex(out[2 * (i - sides)].position + offset, sf::Color::White);
+            out[2 * i + 1] = sf::Vertex(out[2 * (i - sides) + 1].position + offset, sf::Color::White);
+        }
+        if (++side == sides) {
+            side = 0;
+            ++polygon;
+        }
+    }
+}
+
+// Fractal: a Koch snowflake. Each recursion step replaces every line with four
+// lines a third as long, the middle two bending outwards into a spike, so depth
+// 'detail' (0 to 10) has 3 * 4^detail lines.
+int kochDepth(const PatternSettings& s) { return std::min(10, std::max(0, s.detail)); }
+std::size_t kochSegments(const PatternSettings& s) { return 3 * (std::size_t(1) << (2 * kochDepth(s))); }
+
+// writeKochLine: the 4^depth segments that replace the line from 'from' to 'to',
+// numbered from 'index'; only those in [first, last) are written, and branches
+// entirely outside that range are skipped.
+void writeKochLine(sf::Vertex* out, sf::Vector2f from, sf::Vector2f to, int depth, std::size_t index,
+                   std::size_t first, std::size_t last) {
+    const std::size_t segments = std::size_t(1) << (2 * depth);
+    if (index >= last || index + segments <= first) {
+        return;
+    }
+    if (depth == 0) {
+        out[2 * index] = sf::Vertex(from, sf::Color::White);
+        out[2 * index + 1] = sf::Vertex(to, sf::Color::White);
+        return;
+    }
+    const sf::Vector2f third = (to - from) / 3.0f;
+    const sf::Vector2f a = from + third, b = from + 2.0f * third;
+    // The spike's tip: 'third' turned 60 degrees, measured from 'a'.
+    const float c = 0.5f, s = -0.8660254f;
+    const sf::Vector2f tip = a + sf::Vector2f(third.x * c - third.y * s, third.x * s + third.y * c);
+    const std::size_t quarter = segments / 4;
+    writeKochLine(out, from, a, depth - 1, index, first, last);
+    writeKochLine(out, a, tip, depth - 1, index + quarter, first, last);
+    writeKochLine(out, tip, b, depth - 1, index + 2 * quarter, first, last);
+    writeKochLine(out, b, to, depth - 1, index + 3 * quarter, first, last);
+}
+void writeKochSnowflake(sf::Vertex* out, const PatternSettings& s, std::size_t first, std::size_t last) {
+    sf::Vector2f corners[3];
+    for (int i = 0; i < 3; ++i) {
+        corners[i] = polar(s.center, s.size * 0.8, -M_PI / 2.0 + 2.0 * M_PI * i / 3.0);
+    }
+    const std::size_t perSide = kochSegments(s) / 3;
+    for (int i = 0; i < 3; ++i) {
+        writeKochLine(out, corners[i], corners[(i + 1) % 3], kochDepth(s), i * perSide, first, last);
+    }
+}
+
+struct PatternGenerator {
+    const char* name;
+    const char* parameters; // What 'count' and 'detail' mean for this pattern.
+    std::size_t (*segmentCount)(const PatternSettings&);
+    void (*writeSegments)(sf::Vertex* out, const PatternSettings&, std::size_t first, std::size_t last);
+
+    std::size_t vertexCount(const PatternSettings& settings) const { return 2 * segmentCount(settings); }
+    void write(sf::Vertex* out, const PatternSettings& settings) const {
+        writeSegments(out, settings, 0, segmentCount(settings));
+    }
+};
+
+const PatternGenerator patternGenerators[] = {
+    {"starburst", "count = rays", countSegments, writeStarburstPattern},
+    {"spiral", "count = segments, detail = turns", countSegments, writeSpiral},
+    {"rose", "count = segments, detail = k", countSegments, writeRose},
+    {"lissajous", "count = segments, detail = x frequency", countSegments, writeLissajous},
+    {"polygons", "count = polygons per row, detail = sides", polygonGridSegments, writePolygonGrid},
+    {"koch", "detail = recursion depth (0-10)", kochSegments, writeKochSnowflake},
+};
+const std::size_t patternGeneratorCount = sizeof(patternGenerators) / sizeof(patternGenerators[0]);
+
+// findPattern: the generator called 'name', or nullptr.
+const PatternGenerator* findPattern(const std::string& name) {
+    for (const auto& generator : patternGenerators) {
+        if (name == generator.name) {
+            return &generator;
+        }
+    }
+    return nullptr;
+}
+
+// MaxPatternSegments: the largest pattern the demo will generate, 16M segments
+// (about 640 MB of vertices). The polygon grid grows with count squared, so a few
+// presses of Up would otherwise ask for tens of GB; settings past the limit are
+// refused before anything is allocated.
+constexpr std::size_t MaxPatternSegments = std::size_t(1) << 24;
+
+bool patternFits(const PatternGenerator& generator, const PatternSettings& settings) {
+    return generator.segmentCount(settings) <= MaxPatternSegments;
+}
+
+// writePattern: writes the whole pattern into 'out', which must hold
+// generator.vertexCount(settings) vertices. With a pool, the segments are cut into
+// one contiguous slice per thread; each thread writes only its own part of the
+// array, so nothing is shared and nothing needs a lock. Slices start at multiples
+// of 512 segments (the starburst's reseed interval), which keeps the output the
+// same as a single thread's, except for float rounding in the polygon grid.
+void writePattern(const PatternGenerator& generator, const PatternSettings& settings, sf::Vertex* out,
+                  WorkerPool* pool = nullptr) {
+    constexpr std::size_t Granule = 512;
+    constexpr std::size_t MinSliceSegments = 16 * Granule; // Smaller jobs aren't worth a wake-up.
+    const std::size_t segments = generator.segmentCount(settings);
+    const std::size_t slices = pool ? std::min<std::size_t>(pool->size(), segments / MinSliceSegments + 1) : 1;
+    if (slices <= 1) {
+        generator.writeSegments(out, settings, 0, segments);
+        return;
+    }
+    const std::size_t granules = (segments + Granule - 1) / Granule;
+    auto writeSlice = [&](std::size_t slice) {
+        const std::size_t first = std::min(segments, granules * slice / slices * Granule);
+        const std::size_t last = std::min(segments, granules * (slice + 1) / slices * Granule);
+        generator.writeSegments(out, settings, first, last);
+    };
+    pool->run(slices, std::ref(writeSlice));
+}
+
+std::vector<sf::Vertex> generatePattern(const PatternGenerator& generator, const PatternSettings& settings,
+                                        WorkerPool* pool = nullptr) {
+    std::vector<sf::Vertex> vertices(generator.vertexCount(settings));
+    writePattern(generator, settings, vertices.data(), pool);
+    return vertices;
+}
+
+// --- Retained Geometry ---
+// window.draw(vertices.data(), count, sf::Lines) is "immediate mode": every call
+// copies all vertices from our memory to the GPU again, even though the starburst
+// never changes. With a million rays that is 40 MB of vertex data per frame.
+//
+// sf::VertexBuffer keeps the vertices in GPU memory instead. We upload them once
+// (with the Static usage hint, telling the driver they will rarely change), and
+// every frame afterwards is a single draw call that sends no vertex data at all.
+// Vertex buffers need OpenGL support that very old drivers may lack, so
+// PatternGeometry falls back to the immediate-mode path when they are unavailable.
+class PatternGeometry : public sf::Drawable {
+public:
+    // Creates the geometry. Call this after the window exists: checking for vertex
+    // buffer support needs the window's OpenGL context.
+    explicit PatternGeometry(std::vector<sf::Vertex> vertices, bool preferRetained = true)
+        : vertices(std::move(vertices)), buffer(sf::Lines, sf::VertexBuffer::Static) {
+        if (preferRetained && sf::VertexBuffer::isAvailable() && buffer.create(this->vertices.size())) {
+            retained = buffer.update(this->vertices.data());
+        }
+    }
+
+    bool isRetained() const { return retained; }
+    std::size_t vertexCount() const { return vertices.size(); }
+    const std::vector<sf::Vertex>& getVertices() const { return vertices; }
+
+    // regenerate: rewrites the pattern in place, e.g. every frame or after its
+    // settings changed. The vertex count is known before anything is written, and
+    // both copies only ever grow: the vector keeps its capacity when the pattern
+    // shrinks, and the GPU buffer is only re-created when the pattern outgrows it
+    // (draw() then uses just the first vertexCount() vertices). Once both are big
+    // enough, regenerating allocates no memory at all (see --check-allocations).
+    // With a pool, the vertices are written by several threads (see writePattern).
+    void regenerate(const PatternGenerator& generator, const PatternSettings& settings, WorkerPool* pool = nullptr) {
+        vertices.resize(generator.vertexCount(settings));
+        writePattern(generator, settings, vertices.data(), pool);
+        if (retained) {
+            buffer.setUsage(sf::VertexBuffer::Stream); // The pattern now changes often.
+            retained = (buffer.getVertexCount() >= vertices.size() || buffer.create(vertices.size())) &&
+                       buffer.update(vertices.data(), vertices.size(), 0);
+        }
+    }
+
+    // recolor: gives every vertex the same color, writing only the color fields,
+    // then re-uploads the buffer (SFML can only update whole vertices). This is
+    // the color animation's fallback when shaders are not available; the first
+    // call switches the buffer to the Stream hint, since it now changes every frame.
+    void recolor(sf::Color color) {
+        for (auto& vertex : vertices) {
+            vertex.color = color;
+        }
+        if (retained) {
+            buffer.setUsage(sf::VertexBuffer::Stream);
+            buffer.update(vertices.data(), vertices.size(), 0);
+        }
+    }
+
+private:
+    // Called by window.draw(geometry).
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        if (retained) {
+            // One draw call; the vertices are already on the GPU.
+            target.draw(buffer, 0, vertices.size(), states);
+        } else {
+            target.draw(vertices.data(), vertices.size(), sf::Lines, states); // Re-sent every frame.
+        }
+    }
+
+    std::vector<sf::Vertex> vertices; // Our copy, used by the fallback path.
+    sf::VertexBuffer buffer;          // The GPU copy, used when 'retained' is true.
+    bool retained = false;
+};
+
+// --- Software Rasterizer ---
+// Drawing with SFML needs an OpenGL context, and on Linux that needs a display
+// (an X server). Build servers and CI machines usually have neither, so the
+// lines can also be drawn on the CPU into an array of pixels in ordinary memory.
+//
+// SoftwareRasterizer draws sf::Lines vertex pairs with Xiaolin Wu's antialiasing:
+// step one pixel at a time along the line's longer axis, and split each step's
+// ink between the two pixels the ideal line passes between, in proportion to how
+// close it is to each. (With antialiasing off, each step fills the nearest pixel
+// instead, like Bresenham's algorithm.)
+// - SIMD: the positions and coverages of 8 consecutive steps are computed at once
+//   with AVX2 when the compiler targets it (-mavx2), and one at a time otherwise.
+// - Tiles: the framebuffer is split into horizontal bands, one task per band, run
+//   on a WorkerPool. Every task walks all the lines but only touches its own rows,
+//   so no two threads ever write the same pixel and no locking is needed. Within a
+//   row, lines are blended in their original order, so the image is identical
+//   whatever the number of threads.
+//
+// Pixels are 32-bit RGBA, laid out the way sf::Image expects (red in the lowest
+// byte on little-endian machines), so a frame can be saved with sf::Image.
+class SoftwareRasterizer {
+public:
+    SoftwareRasterizer(unsigned width, unsigned height, WorkerPool* pool = nullptr)
+        : width(width), height(height), pixels(static_cast<std::size_t>(width) * height), pool(pool) {}
+
+    unsigned getWidth() const { return width; }
+    unsigned getHeight() const { return height; }
+    const sf::Uint8* data() const { return reinterpret_cast<const sf::Uint8*>(pixels.data()); }
+
+    void setAntialiasing(bool enabled) { antialiasing = enabled; }
+
+    void clear(sf::Color color) { std::fill(pixels.begin(), pixels.end(), pack(color)); }
+
+    // drawLines: blends each vertex pair as a 1-pixel line in the first vertex's color,
+    // after moving both ends by 'transform' (as the GPU does with RenderStates).
+    void drawLines(const sf::Vertex* vertices, std::size_t count,
+                   const sf::Transform& transform = sf::Transform::Identity) {
+        const std::size_t tiles = pool ? std::min<std::size_t>(height, pool->size() * 4) : 1;
+        auto drawTile = [&](std::size_t tile) {
+            const int rowBegin = static_cast<int>(height * tile / tiles);
+            const int rowEnd = static_cast<int>(height * (tile + 1) / tiles);
+            for (std::size_t i = 0; i + 1 < count; i += 2) {
+                drawLine(transform.transformPoint(vertices[i].position),
+                         transform.transformPoint(vertices[i + 1].position), vertices[i].color, rowBegin, rowEnd);
+            }
+        };
+        if (tiles == 1) {
+            drawTile(0);
+        } else {
+            pool->run(tiles, std::ref(drawTile)); // A std::function of a reference never allocates.
+        }
+    }
+
+    // hash: FNV-1a over the pixels; equal images have equal hashes.
+    std::uint64_t hash() const {
+        std::uint64_t h = 14695981039346656037ull;
+        for (std::uint32_t pixel : pixels) {
+            h = (h ^ pixel) * 1099511628211ull;
+        }
+        return h;
+    }
+
+private:
+    static std::uint32_t pack(sf::Color c) {
+        return static_cast<std::uint32_t>(c.r) | (static_cast<std::uint32_t>(c.g) << 8) |
+               (static_cast<std::uint32_t>(c.b) << 16) | (static_cast<std::uint32_t>(c.a) << 24);
+    }
+
+    // blend: pixel = pixel + (color - pixel) * amount / 256, on two channels at a
+    // time (red+blue and green+alpha each fit in one 32-bit word with room to spare).
+    static void blend(std::uint32_t& pixel, std::uint32_t color, std::uint32_t amount) {
+        const std::uint32_t rb = pixel & 0x00FF00FFu, ga = (pixel >> 8) & 0x00FF00FFu;
+        const std::uint32_t srcRb = color & 0x00FF00FFu, srcGa = (color >> 8) & 0x00FF00FFu;
+        const std::uint32_t newRb = (rb + (((srcRb - rb) * amount) >> 8)) & 0x00FF00FFu;
+        const std::uint32_t newGa = (ga + (((srcGa - ga) * amount) >> 8)) & 0x00FF00FFu;
+        pixel = newRb | (newGa << 8);
+    }
+
+    void plot(int x, int y, std::uint32_t color, std::uint32_t amount) {
+        if (amount != 0 && static_cast<unsigned>(x) < width) {
+            blend(pixels[static_cast<std::size_t>(y) * width + x], color, amount);
+        }
+    }
+
+    // Step positions for a batch of 8 steps: minor = start + gradient * (first + k).
+    // 'start' and the step numbers are counted from the line's own first step, not
+    // from where a tile begins, so every tile computes bit-identical positions.
+    struct Steps {
+        alignas(32) std::int32_t cell[8];    // floor(minor)
+        alignas(32) float fraction[8];       // minor - floor(minor)
+    };
+
+    static void computeSteps(float start, float gradient, int first, Steps& steps) {
+#if defined(__AVX2__)
+        const __m256 offsets = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(first)), offsets);
+        __m256 minor = _mm256_add_ps(_mm256_set1_ps(start), _mm256_mul_ps(_mm256_set1_ps(gradient), index));
+        __m256 floored = _mm256_floor_ps(minor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(steps.cell), _mm256_cvttps_epi32(floored));
+        _mm256_store_ps(steps.fraction, _mm256_sub_ps(minor, floored));
+#else
+        for (int k = 0; k < 8; ++k) {
+            float minor = start + gradient * static_cast<float>(first + k);
+            float floored = std::floor(minor);
+            steps.cell[k] = static_cast<std::int32_t>(floored);
+            steps.fraction[k] = minor - floored;
+        }
+#endif
+    }
+
+    // drawLine: the part of one line that falls in rows [rowBegin, rowEnd).
+    void drawLine(sf::Vector2f from, sf::Vector2f to, sf::Color color, int rowBegin, int rowEnd) {
+        const std::uint32_t packed = pack(color);
+        const float dx = to.x - from.x, dy = to.y - from.y;
+        const bool steep = std::abs(dy) > std::abs(dx);
+        Steps steps;
+
+        if (steep) {
+            // Major axis y: one step per row, so clipping to the tile is just the row range.
+            if (from.y > to.y) {
+                std::swap(from, to);
+            }
+            const float gradient = dy == 0.0f ? 0.0f : (to.x - from.x) / (to.y - from.y);
+            const int anchor = static_cast<int>(std::lround(from.y)); // The line's first row.
+            const int first = std::max(rowBegin, anchor);
+            const int last = std::min(rowEnd - 1, static_cast<int>(std::lround(to.y)));
+            // x at row r is from.x + gradient * (r - from.y).
+            const float start = from.x + gradient * (static_cast<float>(anchor) - from.y);
+            for (int row = first; row <= last; row += 8) {
+                computeSteps(start, gradient, row - anchor, steps);
+                const int batch = std::min(8, last - row + 1);
+                for (int k = 0; k < batch; ++k) {
+                    plotPair(steps.cell[k], row + k, 1, 0, steps.fraction[k], packed, color.a);
+                }
+            }
+            return;
+        }
+
+        // Major axis x: only the columns whose two pixels can reach this tile's rows.
+        if (from.x > to.x) {
+            std::swap(from, to);
+        }
+        const float gradient = dx == 0.0f ? 0.0f : (to.y - from.y) / (to.x - from.x);
+        const int anchor = static_cast<int>(std::lround(from.x)); // The line's first column.
+        int first = anchor;
+        int last = static_cast<int>(std::lround(to.x));
+        if (gradient == 0.0f) {
+            const int row = static_cast<int>(std::floor(from.y));
+            if (row + 1 < rowBegin || row >= rowEnd) {
+                return;
+            }
+        } else {
+            // Columns where the line is between rows rowBegin - 1 and rowEnd.
+            float a = from.x + (static_cast<float>(rowBegin - 1) - from.y) / gradient;
+            float b = from.x + (static_cast<float>(rowEnd) - from.y) / gradient;
+            const float low = std::floor(std::min(a, b)) - 1.0f, high = std::ceil(std::max(a, b)) + 1.0f;
+            if (low > static_cast<float>(first)) { // Compare as floats: 'low' may be far out of int range.
+                first = static_cast<int>(low);
+            }
+            if (high < static_cast<float>(last)) {
+                last = static_cast<int>(high);
+            }
+        }
+        first = std::max(first, 0);
+        last = std::min(last, static_cast<int>(width) - 1);
+        const float start = from.y + gradient * (static_cast<float>(anchor) - from.x);
+        for (int column = first; column <= last; column += 8) {
+            computeSteps(start, gradient, column - anchor, steps);
+            const int batch = std::min(8, last - column + 1);
+            for (int k = 0; k < batch; ++k) {
+                const int row = steps.cell[k];
+                if (row + 1 >= rowBegin && row < rowEnd) {
+                    plotPair(column + k, row, 0, 1, steps.fraction[k], packed, color.a, rowBegin, rowEnd);
+                }
+            }
+        }
+    }
+
+    // plotPair: the two pixels of one step, (x, y) and (x + stepX, y + stepY), sharing
+    // the step's ink by 'fraction'. Rows outside [rowBegin, rowEnd) belong to
+    // another tile.
+    void plotPair(int x, int y, int stepX, int stepY, float fraction, std::uint32_t color, sf::Uint8 alpha,
+                  int rowBegin = INT_MIN, int rowEnd = INT_MAX) {
+        const float strength = static_cast<float>(alpha) * (256.0f / 255.0f);
+        if (!antialiasing) {
+            const bool far = fraction >= 0.5f;
+            const int row = far ? y + stepY : y;
+            if (row >= rowBegin && row < rowEnd) {
+                plot(far ? x + stepX : x, row, color, static_cast<std::uint32_t>(strength));
+            }
+            return;
+        }
+        if (y >= rowBegin && y < rowEnd) {
+            plot(x, y, color, static_cast<std::uint32_t>(strength * (1.0f - fraction)));
+        }
+        if (y + stepY >= rowBegin && y + stepY < rowEnd) {
+            plot(x + stepX, y + stepY, color, static_cast<std::uint32_t>(strength * fraction));
+        }
+    }
+
+    unsigned width, height;
+    std::vector<std::uint32_t> pixels;
+    WorkerPool* pool;
+    bool antialiasing = true;
+};
+
+// --- Render Backends ---
+// The frame loop talks to a RenderBackend, so the same loop can draw with SFML
+// (into a window or a RenderTexture) or with the SoftwareRasterizer.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+    virtual const char* name() const = 0;
+    virtual void beginFrame(sf::Color background) = 0;
+    virtual void draw(const PatternGeometry& geometry, const sf::RenderStates& states) = 0;
+    virtual void endFrame() = 0; // Returns once the frame is complete.
+};
+
+// SfmlBackend: draws through SFML into a RenderWindow or RenderTexture.
+template<typename TTarget>
+class SfmlBackend : public RenderBackend {
+public:
+    explicit SfmlBackend(TTarget& target, const char* label) : target(target), label(label) {}
+    const char* name() const override { return label; }
+    void beginFrame(sf::Color background) override { target.clear(background); }
+    void draw(const PatternGeometry& geometry, const sf::RenderStates& states) override {
+        target.draw(geometry, states);
+    }
+    void endFrame() override {
+        target.display();
+        glFinish(); // Wait for the GPU, so frame times include its work.
+    }
+
+private:
+    TTarget& target;
+    const char* label;
+};
+
+// SoftwareBackend: draws with a SoftwareRasterizer; no GPU or display needed.
+class SoftwareBackend : public RenderBackend {
+public:
+    SoftwareBackend(unsigned width, unsigned height, WorkerPool* pool) : rasterizer(width, height, pool) {}
+    const char* name() const override { return "software rasterizer"; }
+    void beginFrame(sf::Color background) override { rasterizer.clear(background); }
+    void draw(const PatternGeometry& geometry, const sf::RenderStates& states) override {
+        // Uses the transform only; shaders need the GPU (see StarburstAnimation).
+        rasterizer.drawLines(geometry.getVertices().data(), geometry.getVertices().size(), states.transform);
+    }
+    void endFrame() override {}
+
+    SoftwareRasterizer& getRasterizer() { return rasterizer; }
+
+private:
+    SoftwareRasterizer rasterizer;
+};
+
+// --- Animation ---
+// The starburst can rotate, pulse (every ray grows and shrinks together) and cycle
+// its color. None of this needs new ray positions: turning and scaling every ray
+// about the center is exactly what an sf::Transform does, and SFML passes the
+// transform to the GPU with the draw call, so the vertex buffer is never touched.
+// The color goes to the GPU the same way, as the "tint" uniform of a small fragment
+// shader. A frame therefore costs the same CPU time at 36 rays as at a million.
+//
+// Without shader support, prepare() falls back to PatternGeometry::recolor, which
+// rewrites only the color of each vertex; the rays are still never regenerated.
+class StarburstAnimation {
+public:
+    // 'allowShader' is false when there is no OpenGL context to compile a shader in
+    // (the software backend); colors are then always updated in place.
+    explicit StarburstAnimation(sf::Vector2f center, bool allowShader = true) : center(center) {
+        if (allowShader && sf::Shader::isAvailable()) {
+            shaderReady = tintShader.loadFromMemory(TintShaderSource, sf::Shader::Fragment);
+        }
+    }
+
+    void setTime(float seconds) { time = seconds; }
+    bool usesShader() const { return shaderReady; }
+
+    float getRotation() const { return DegreesPerSecond * time; }
+    float getScale() const { return 1.0f + PulseAmount * std::sin(PulsePerSecond * time); }
+
+    // getTint: each channel follows a sine wave a third of a turn behind the last,
+    // which walks the color around the hue circle.
+    sf::Color getTint() const {
+        auto channel = [&](float phase) {
+            return static_cast<sf::Uint8>(127.5f + 127.5f * std::sin(HuePerSecond * time + phase));
+        };
+        return sf::Color(channel(0.0f), channel(2.0944f), channel(4.1888f));
+    }
+
+    // getTransform: scale, then rotate, both about the center.
+    sf::Transform getTransform() const {
+        sf::Transform transform;
+        transform.rotate(getRotation(), center).scale(getScale(), getScale(), center.x, center.y);
+        return transform;
+    }
+
+    // prepare: returns the render states that draw 'geometry' at the current time.
+    // Only touches the geometry when the color cannot go through the shader.
+    sf::RenderStates prepare(PatternGeometry& geometry) {
+        sf::RenderStates states(getTransform());
+        if (shaderReady) {
+            tintShader.setUniform("tint", sf::Glsl::Vec4(getTint()));
+            states.shader = &tintShader;
+        } else {
+            geometry.recolor(getTint());
+        }
+        return states;
+    }
+
+private:
+    // SFML's fixed-function vertex stage passes the vertex color through as gl_Color.
+    static constexpr const char* TintShaderSource =
+        "uniform vec4 tint;\n"
+        "void main() { gl_FragColor = gl_Color * tint; }\n";
+    static constexpr float DegreesPerSecond = 30.0f;
+    static constexpr float PulseAmount = 0.25f;   // Rays vary between 75% and 125% of rayLength.
+    static constexpr float PulsePerSecond = 2.0f; // Radians per second.
+    static constexpr float HuePerSecond = 1.0f;
+
+    sf::Vector2f center;
+    float time = 0.0f;
+    sf::Shader tintShader;
+    bool shaderReady = false;
+};
+
+// --- Frame Timing ---
+// FrameTimer splits each frame into its phases (handling events, updating the
+// geometry, submitting the draw calls, and display(), which also includes the
+// frame-rate limiter's sleep) and keeps the last 'capacity' frames in a ring
+// buffer, allocated once. From there they can be drawn as a graph over the
+// pattern (writeGraph), averaged, or saved as CSV (writeCsv).
+class FrameTimer {
+public:
+    enum Phase { Poll, Update, Draw, Display, PhaseCount };
+    struct Frame {
+        double ms[PhaseCount];
+    };
+
+    explicit FrameTimer(std::size_t capacity = 3600) : frames(capacity) {}
+
+    // start: the frame begins now, with its first phase.
+    void start() {
+        current = Frame();
+        lapStart = std::chrono::steady_clock::now();
+    }
+
+    // lap: 'phase' has just finished; the next one starts now.
+    void lap(Phase phase) {
+        const auto now = std::chrono::steady_clock::now();
+        current.ms[phase] = std::chrono::duration<double, std::milli>(now - lapStart).count();
+        lapStart = now;
+    }
+
+    // finish: stores the frame, overwriting the oldest one once the buffer is full.
+    void finish() {
+        frames[next] = current;
+        next = (next + 1) % frames.size();
+        stored = std::min(stored + 1, frames.size());
+    }
+
+    std::size_t size() const { return stored; }
+
+    // frame(0) is the oldest stored frame, frame(size() - 1) the latest.
+    const Frame& frame(std::size_t i) const { return frames[(next + frames.size() - stored + i) % frames.size()]; }
+
+    double average(Phase phase) const {
+        double total = 0.0;
+        for (std::size_t i = 0; i < stored; ++i) {
+            total += frame(i).ms[phase];
+        }
+        return stored > 0 ? total / stored : 0.0;
+    }
+
+    // writeGraph: replaces 'out' with lines for a bar graph of the latest 'width'
+    // frames, one pixel column each, growing up from 'bottomLeft'. Each bar stacks
+    // the phases: poll (blue), update (green), draw (yellow), display (red). A
+    // grey line marks 1/60 s. Reuses the capacity of 'out' from frame to frame.
+    void writeGraph(std::vector<sf::Vertex>& out, sf::Vector2f bottomLeft, std::size_t width,
+                    float pixelsPerMs) const {
+        static const sf::Color colors[PhaseCount] = {sf::Color(80, 120, 255), sf::Color::Green, sf::Color::Yellow,
+                                                     sf::Color::Red};
+        out.clear();
+        const std::size_t shown = std::min(width, stored);
+        for (std::size_t column = 0; column < shown; ++column) {
+            const Frame& shownFrame = frame(stored - shown + column);
+            const float x = bottomLeft.x + static_cast<float>(column) + 0.5f;
+            float y = bottomLeft.y;
+            for (int phase = 0; phase < PhaseCount; ++phase) {
+                const float top = y - static_cast<float>(shownFrame.ms[phase]) * pixelsPerMs;
+                out.emplace_back(sf::Vector2f(x, y), colors[phase]);
+                out.emplace_back(sf::Vector2f(x, top), colors[phase]);
+                y = top;
+            }
+        }
+        const float budgetY = bottomLeft.y - 1000.0f / 60.0f * pixelsPerMs;
+        out.emplace_back(sf::Vector2f(bottomLeft.x, budgetY), sf::Color(128, 128, 128));
+        out.emplace_back(sf::Vector2f(bottomLeft.x + width, budgetY), sf::Color(128, 128, 128));
+    }
+
+    // writeCsv: one line per stored frame, oldest first, with a header line.
+    bool writeCsv(const std::string& path) const {
+        std::ofstream file(path);
+        file << "frame,poll_ms,update_ms,draw_ms,display_ms\n";
+        for (std::size_t i = 0; i < stored; ++i) {
+            const Frame& f = frame(i);
+            file << i << ',' << f.ms[Poll] << ',' << f.ms[Update] << ',' << f.ms[Draw] << ',' << f.ms[Display] << '\n';
+        }
+        return static_cast<bool>(file);
+    }
+
+private:
+    std::vector<Frame> frames; // The ring buffer.
+    std::size_t next = 0;      // Where the next frame goes.
+    std::size_t stored = 0;    // How many frames it holds.
+    Frame current;
+    std::chrono::steady_clock::time_point lapStart;
+};
+
+// --- Pattern Options ---
+// The pattern can be chosen on the command line, in the window and in headless mode:
+//   --pattern NAME  --count N  --detail N  --size PIXELS
+// (--rays N is the same as --count N). parsePatternArgument reads one of these
+// starting at argv[i], moving i past its value, and returns false for anything else.
+bool parsePatternArgument(int argc, char** argv, int& i, const PatternGenerator*& pattern,
+                          PatternSettings& settings) {
+    const std::string argument = argv[i];
+    if (i + 1 >= argc) {
+        return false;
+    }
+    const PatternGenerator* previousPattern = pattern;
+    const PatternSettings previousSettings = settings;
+    if (argument == "--pattern") {
+        if (const PatternGenerator* found = findPattern(argv[i + 1])) {
+            pattern = found;
+        } else {
+            std::cerr << "unknown pattern '" << argv[i + 1] << "'; using " << pattern->name << std::endl;
+        }
+    } else if (argument == "--count" || argument == "--rays") {
+        settings.count = std::max(1, std::atoi(argv[i + 1]));
+    } else if (argument == "--detail") {
+        settings.detail = std::max(0, std::atoi(argv[i + 1]));
+    } else if (argument == "--size") {
+        settings.size = static_cast<float>(std::atof(argv[i + 1]));
+    } else {
+        return false;
+    }
+    if (!patternFits(*pattern, settings)) {
+        std::cerr << argument << ' ' << argv[i + 1] << ": more than " << MaxPatternSegments << " segments for "
+                  << pattern->name << "; ignored" << std::endl;
+        pattern = previousPattern;
+        settings = previousSettings;
+    }
+    ++i;
+    return true;
+}
+
+// --- Headless Mode ---
+// --headless renders a fixed number of frames off-screen as fast as possible and
+// prints frame-time percentiles and throughput in pixels per second:
+//   --headless [frames] [pattern options] [--cpu] [--animate] [--save image.png]
+// Frames go into an sf::RenderTexture (GPU, no window) when an OpenGL context
+// can be created, and through the SoftwareRasterizer otherwise or with --cpu.
+// The software path also prints a hash of the last frame, so CI can check that
+// the output has not changed. --animate plays the animation at 60 steps per
+// second of animation time, to check that animated frames cost no more than still ones.
+struct HeadlessOptions {
+    int frames = 600;
+    const PatternGenerator* pattern = &patternGenerators[0];
+    PatternSettings settings; // Centered in the 800x600 frame.
+    bool cpu = false;
+    bool animate = false;
+    std::string savePath; // Save the last frame here if not empty.
+};
+
+HeadlessOptions parseHeadlessOptions(int argc, char** argv) {
+    HeadlessOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (parsePatternArgument(argc, argv, i, options.pattern, options.settings)) {
+            continue;
+        } else if (argument == "--save" && i + 1 < argc) {
+            options.savePath = argv[++i];
+        } else if (argument == "--cpu") {
+            options.cpu = true;
+        } else if (argument == "--animate") {
+            options.animate = true;
+        } else {
+            options.frames = std::max(1, std::atoi(argument.c_str()));
+        }
+    }
+    return options;
+}
+
+// canUseOpenGL: SFML's Linux backend opens the X display to create any OpenGL
+// context (even for a RenderTexture) and aborts the program if that fails, so
+// check for a display before trying.
+bool canUseOpenGL() {
+#if defined(__linux__)
+    return std::getenv("DISPLAY") != nullptr;
+#else
+    return true;
+#endif
+}
+
+void reportFrameTimes(const char* target, std::vector<double> frameMs, unsigned width, unsigned height) {
+    double total = 0.0;
+    for (double ms : frameMs) {
+        total += ms;
+    }
+    std::sort(frameMs.begin(), frameMs.end());
+    auto percentile = [&](double p) { return frameMs[static_cast<std::size_t>(p / 100.0 * (frameMs.size() - 1))]; };
+    std::cout << "headless (" << target << ", " << width << "x" << height << "): " << frameMs.size() << " frames\n"
+              << "  frame time p50 " << percentile(50) << " ms, p90 " << percentile(90) << " ms, p99 "
+              << percentile(99) << " ms, max " << frameMs.back() << " ms\n"
+              << "  " << static_cast<double>(width) * height * frameMs.size() / (total / 1000.0) / 1e6
+              << " Mpixels/s" << std::endl;
+}
+
+int runHeadless(const HeadlessOptions& options) {
+    const unsigned width = 800, height = 600;
+    sf::RenderTexture texture;
+    WorkerPool pool;
+    std::unique_ptr<RenderBackend> backend;
+    if (!options.cpu && canUseOpenGL() && texture.create(width, height)) {
+        backend.reset(new SfmlBackend<sf::RenderTexture>(texture, "RenderTexture"));
+    } else {
+        backend.reset(new SoftwareBackend(width, height, &pool));
+    }
+    // Created after the RenderTexture, whose OpenGL context the vertex buffer needs.
+    // The software path has no context at all, so it must not try to make a buffer.
+    const bool onGpu = dynamic_cast<SoftwareBackend*>(backend.get()) == nullptr;
+    PatternGeometry geometry(generatePattern(*options.pattern, options.settings, &pool), onGpu);
+    StarburstAnimation animation(options.settings.center, onGpu);
+
+    std::vector<double> frameMs;
+    frameMs.reserve(options.frames);
+    for (int i = 0; i < options.frames; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        backend->beginFrame(sf::Color::Black);
+        if (options.animate) {
+            animation.setTime(i / 60.0f);
+            backend->draw(geometry, animation.prepare(geometry));
+        } else {
+            backend->draw(geometry, sf::RenderStates::Default);
+        }
+        backend->endFrame();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        frameMs.push_back(elapsed.count());
+    }
+    reportFrameTimes(backend->name(), frameMs, width, height);
+
+    sf::Image image;
+    if (auto* software = dynamic_cast<SoftwareBackend*>(backend.get())) {
+        std::cout << "  image hash " << std::hex << software->getRasterizer().hash() << std::dec << std::endl;
+        image.create(width, height, software->getRasterizer().data());
+    } else if (!options.savePath.empty()) {
+        image = texture.getTexture().copyToImage();
+    }
+    if (!options.savePath.empty()) {
+        image.saveToFile(options.savePath);
+    }
+    return 0;
+}
+
+// --- Allocation Check ---
+// Regenerating a pattern every frame should not touch the heap once its storage
+// is big enough (see PatternGeometry::regenerate). To check that, this program
+// replaces the global operator new with one that counts its calls, and
+// --check-allocations runs every generator through animated frames, regenerating
+// at alternating sizes each frame and drawing with the software backend, and
+// reports how many allocations the frames made after the first one. Any number
+// other than zero is a failure, and the program exits with status 1.
+std::atomic<std::size_t> allocationCount{0};
+
+// GCC sees malloc and free through these definitions and warns when it cannot
+// prove they are paired, which they always are here.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+// settingsWithSegments: settings that give 'generator' about 'segments' segments.
+PatternSettings settingsWithSegments(const PatternGenerator& generator, std::size_t segments) {
+    PatternSettings settings;
+    if (std::string(generator.name) == "polygons") {
+        settings.detail = 6; // A grid of hexagons.
+        settings.count = static_cast<int>(std::sqrt(segments / 6.0));
+    } else if (std::string(generator.name) == "koch") {
+        settings.detail = static_cast<int>(std::log(segments / 3.0) / std::log(4.0) + 0.5);
+    } else {
+        settings.count = static_cast<int>(segments);
+    }
+    return settings;
+}
+
+// runAllocationCheck: every pattern at a small size, then at about 50000 segments.
+// The large size is above writePattern's MinSliceSegments even on the smaller odd
+// frames, and the pool has several threads however many cores there are, so the
+// sliced, multi-threaded path is checked as well as the single-threaded one.
+int runAllocationCheck() {
+    const unsigned width = 800, height = 600;
+    WorkerPool pool(std::max(4u, std::thread::hardware_concurrency()));
+    SoftwareBackend backend(width, height, &pool);
+    const int frames = 120;
+    bool passed = true;
+    std::cout << "allocations per " << frames << " frames, after the first:" << std::endl;
+    auto check = [&](const PatternGenerator& generator, const PatternSettings& settings) {
+        PatternGeometry geometry(generatePattern(generator, settings), false);
+        StarburstAnimation animation(settings.center, false);
+        auto drawFrame = [&](int frame) {
+            // Odd frames are smaller: the storage must be reused, not shrunk and regrown.
+            PatternSettings frameSettings = settings;
+            frameSettings.count -= (frame % 2) * settings.count / 2;
+            frameSettings.detail -= frame % 2;
+            geometry.regenerate(generator, frameSettings, &pool);
+            animation.setTime(frame / 60.0f);
+            backend.beginFrame(sf::Color::Black);
+            backend.draw(geometry, animation.prepare(geometry));
+            backend.endFrame();
+        };
+        drawFrame(0);
+        const std::size_t before = allocationCount.load();
+        for (int frame = 1; frame <= frames; ++frame) {
+            drawFrame(frame);
+        }
+        const std::size_t allocations = allocationCount.load() - before;
+        passed = passed && allocations == 0;
+        std::cout << "  " << generator.name << ", " << generator.segmentCount(settings) << " segments: " << allocations
+                  << (allocations == 0 ? " (ok)" : " (FAILED)") << std::endl;
+    };
+    for (const auto& generator : patternGenerators) {
+        PatternSettings small;
+        small.count = std::string(generator.name) == "polygons" ? 20 : 2000;
+        small.detail = 5;
+        check(generator, small);
+        check(generator, settingsWithSegments(generator, 50000));
+    }
+    return passed ? 0 : 1;
+}
+
+// --- Benchmarks ---
+// Run with --bench [name] to time parts of the demo instead of showing it.
+
+// averageFrameMilliseconds: draws 'frames' frames as fast as possible and returns
+// the average time per frame. glFinish() waits until the GPU has actually finished
+// each frame, so the time covers the vertex transfer and drawing, not just the
+// time taken to queue the commands.
+double averageFrameMilliseconds(sf::RenderWindow& window, const PatternGeometry& geometry, int frames) {
+    auto drawFrame = [&] {
+        window.clear(sf::Color::Black);
+        window.draw(geometry);
+        window.display();
+        glFinish();
+    };
+    for (int i = 0; i < 10; ++i) {
+        drawFrame(); // Warm-up: let the driver settle (and finish the upload).
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        drawFrame();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+// benchRetained: frame time of the immediate (client-side) path versus the
+// retained vertex buffer, at 36, 10 thousand and 1 million rays.
+void benchRetained() {
+    if (!canUseOpenGL()) {
+        std::cout << "retained: no display; skipped (it needs a window to time the GPU)" << std::endl;
+        return;
+    }
+    sf::RenderWindow window(sf::VideoMode(800, 600), "SFML Starburst Benchmark");
+    window.setVerticalSyncEnabled(false); // Measure our frame cost, not the monitor's refresh rate.
+    window.setFramerateLimit(0);
+    if (!sf::VertexBuffer::isAvailable()) {
+        std::cout << "retained: vertex buffers are not available here; only the client-side path can run." << std::endl;
+    }
+
+    std::cout << "retained: average frame time" << std::endl;
+    for (int rays : {36, 10000, 1000000}) {
+        std::vector<sf::Vertex> vertices = generateStarburst(sf::Vector2f(400.0f, 300.0f), rays, 200.0f);
+        PatternGeometry immediate(vertices, false);
+        PatternGeometry retained(std::move(vertices), true);
+        const int frames = rays >= 1000000 ? 60 : 300;
+        double immediateMs = averageFrameMilliseconds(window, immediate, frames);
+        std::cout << "  " << rays << " rays: client-side " << immediateMs << " ms";
+        if (retained.isRetained()) {
+            std::cout << ", vertex buffer " << averageFrameMilliseconds(window, retained, frames) << " ms";
+        }
+        std::cout << std::endl;
+    }
+}
+
+// threadCountsUpTo: 1, 2, 4, ... up to and including 'cores'.
+std::vector<unsigned> threadCountsUpTo(unsigned cores) {
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < cores; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(cores);
+    return threadCounts;
+}
+
+// benchRaster: SoftwareRasterizer throughput in lines per second, antialiased and
+// not, on 1 to N threads. The image hash must be the same on every row.
+void benchRaster() {
+    const unsigned width = 800, height = 600;
+    const std::vector<unsigned> threadCounts = threadCountsUpTo(std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "raster: " << width << "x" << height << " software rasterizer" << std::endl;
+    for (int rays : {10000, 200000}) {
+        const std::vector<sf::Vertex> vertices =
+            generateStarburst(sf::Vector2f(width / 2.0f, height / 2.0f), rays, 280.0f);
+        for (bool antialiasing : {true, false}) {
+            for (unsigned threads : threadCounts) {
+                WorkerPool pool(threads);
+                SoftwareRasterizer rasterizer(width, height, &pool);
+                rasterizer.setAntialiasing(antialiasing);
+                const int frames = rays >= 200000 ? 3 : 20;
+                auto start = std::chrono::steady_clock::now();
+                for (int frame = 0; frame < frames; ++frame) {
+                    rasterizer.clear(sf::Color::Black);
+                    rasterizer.drawLines(vertices.data(), vertices.size());
+                }
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                std::cout << "  " << rays << " lines, " << (antialiasing ? "antialiased" : "aliased    ") << ", "
+                          << threads << " thread(s): " << rays * frames / elapsed.count() / 1e6 << " M lines/s, hash "
+                          << std::hex << rasterizer.hash() << std::dec << std::endl;
+            }
+        }
+    }
+}
+
+// benchSincos: writeStarburst (rotation recurrence) against the per-ray libm
+// version, with the largest error of each compared to double-precision directions.
+void benchSincos() {
+    const sf::Vector2f center(0.0f, 0.0f);
+    const float rayLength = 1.0f; // Unit rays: positions are the directions themselves.
+    std::cout << "sincos: ray generation, error = largest |direction - exact| over all rays" << std::endl;
+    for (int rays : {36, 10000, 1000000, 10000000}) {
+        std::vector<sf::Vertex> vertices(2 * static_cast<std::size_t>(rays));
+        const int repeats = std::max(1, 20000000 / rays);
+        auto run = [&](void (*write)(sf::Vertex*, sf::Vector2f, int, float)) {
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < repeats; ++r) {
+                write(vertices.data(), center, rays, rayLength);
+            }
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            double error = 0.0;
+            for (int i = 0; i < rays; ++i) {
+                const double angle = 2.0 * M_PI * i / rays;
+                const sf::Vector2f end = vertices[2 * i + 1].position;
+                error = std::max(error, std::max(std::abs(end.x - std::cos(angle)), std::abs(end.y - std::sin(angle))));
+            }
+            return std::make_pair(elapsed.count() / (static_cast<double>(rays) * repeats), error);
+        };
+        auto libm = run(writeStarburstReference);
+        auto rotation = run([](sf::Vertex* out, sf::Vector2f c, int n, float length) {
+            writeStarburst(out, c, n, length);
+        });
+        std::cout << "  " << rays << " rays: libm " << libm.first << " ns/ray (error " << libm.second
+                  << "), rotation " << rotation.first << " ns/ray (error " << rotation.second << ")" << std::endl;
+    }
+}
+
+// benchAnimation: CPU time per animated frame spent updating the starburst, for
+// the three ways to animate it: transform and shader uniform (nothing per vertex),
+// recoloring in place (the no-shader fallback), and regenerating every vertex.
+// With a display, it also compares the full frame time of a still and an animated
+// million-ray starburst drawn from the vertex buffer.
+void benchAnimation() {
+    const sf::Vector2f center(400.0f, 300.0f);
+    const float rayLength = 200.0f;
+    std::cout << "animation: CPU time per frame to update the starburst" << std::endl;
+    for (int rays : {36, 10000, 1000000}) {
+        PatternGeometry geometry(generateStarburst(center, rays, rayLength), false);
+        StarburstAnimation animation(center, false);
+        const int frames = rays >= 1000000 ? 30 : 1000;
+        auto perFrame = [&](auto&& update) {
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; ++frame) {
+                animation.setTime(frame / 60.0f);
+                update();
+            }
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count() / frames;
+        };
+        volatile float sink = 0.0f; // Keeps the transform-only loop from being optimized away.
+        double uniform = perFrame([&] {
+            sink = animation.getTransform().transformPoint(center).x + animation.getTint().r;
+        });
+        double recolor = perFrame([&] { geometry.recolor(animation.getTint()); });
+        double regenerate = perFrame([&] {
+            std::vector<sf::Vertex> vertices = generateStarburst(center, rays, rayLength * animation.getScale());
+            const sf::Transform transform = sf::Transform().rotate(animation.getRotation(), center);
+            const sf::Color tint = animation.getTint();
+            for (auto& vertex : vertices) {
+                vertex.position = transform.transformPoint(vertex.position);
+                vertex.color = tint;
+            }
+            sink = vertices.back().position.x;
+        });
+        std::cout << "  " << rays << " rays: transform + uniform " << uniform << " us, recolor in place " << recolor
+                  << " us, regenerate " << regenerate << " us" << std::endl;
+    }
+
+    if (!canUseOpenGL()) {
+        std::cout << "  (no display: skipping the GPU frame times)" << std::endl;
+        return;
+    }
+    sf::RenderWindow window(sf::VideoMode(800, 600), "SFML Starburst Benchmark");
+    window.setVerticalSyncEnabled(false);
+    window.setFramerateLimit(0);
+    PatternGeometry geometry(generateStarburst(center, 1000000, rayLength));
+    StarburstAnimation animation(center);
+    for (bool animate : {false, true}) {
+        const int frames = 60;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            animation.setTime(frame / 60.0f);
+            window.clear(sf::Color::Black);
+            window.draw(geometry, animate ? animation.prepare(geometry) : sf::RenderStates::Default);
+            window.display();
+            glFinish();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  1000000 rays, " << (animate ? "animated" : "still   ") << " ("
+                  << (geometry.isRetained() ? "vertex buffer" : "client-side") << ", "
+                  << (animation.usesShader() ? "shader tint" : "in-place colors") << "): " << elapsed.count() / frames
+                  << " ms/frame" << std::endl;
+    }
+}
+
+// benchPatterns: how fast each generator fills a pre-sized vertex array, in
+// millions of vertices per second, at about a million vertices per pattern.
+void benchPatterns() {
+    std::cout << "patterns: generation into pre-sized storage" << std::endl;
+    for (const auto& generator : patternGenerators) {
+        const PatternSettings settings = settingsWithSegments(generator, 500000);
+        std::vector<sf::Vertex> vertices(generator.vertexCount(settings));
+        const int repeats = 10;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            generator.write(vertices.data(), settings);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << generator.name << " (" << generator.parameters << "): " << vertices.size()
+                  << " vertices, " << vertices.size() * repeats / elapsed.count() / 1e6 << " M vertices/s"
+                  << std::endl;
+    }
+}
+
+// benchParallel: writePattern on 1 to N threads for each generator at about two
+// million segments: milliseconds per pattern, speed-up over one thread, and the
+// largest difference from the single-threaded vertices (0 except for float
+// rounding in the polygon grid).
+void benchParallel() {
+    const std::vector<unsigned> threadCounts = threadCountsUpTo(std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "parallel: pattern generation on 1 to " << threadCounts.back() << " threads" << std::endl;
+    for (const auto& generator : patternGenerators) {
+        const PatternSettings settings = settingsWithSegments(generator, 2000000);
+        const std::vector<sf::Vertex> reference = generatePattern(generator, settings);
+        std::vector<sf::Vertex> vertices(reference.size());
+        double singleThreadMs = 0.0;
+        for (unsigned threads : threadCounts) {
+            WorkerPool pool(threads);
+            const int repeats = 5;
+            writePattern(generator, settings, vertices.data(), &pool); // Warm-up: touch every page.
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < repeats; ++r) {
+                writePattern(generator, settings, vertices.data(), &pool);
+            }
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            const double ms = elapsed.count() / repeats;
+            if (threads == 1) {
+                singleThreadMs = ms;
+            }
+            float difference = 0.0f;
+            for (std::size_t i = 0; i < vertices.size(); ++i) {
+                difference = std::max({difference, std::abs(vertices[i].position.x - reference[i].position.x),
+                                       std::abs(vertices[i].position.y - reference[i].position.y)});
+            }
+            std::cout << "  " << generator.name << ", " << vertices.size() << " vertices, " << threads
+                      << " thread(s): " << ms << " ms, x" << singleThreadMs / ms << ", difference " << difference
+                      << " px" << std::endl;
+        }
+    }
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+const Benchmark benchmarks[] = {
+    {"retained", benchRetained},
+    {"raster", benchRaster},
+    {"sincos", benchSincos},
+    {"animation", benchAnimation},
+    {"patterns", benchPatterns},
+    {"parallel", benchParallel},
+};
+
+int runBenchmarks(const std::string& filter) {
+    for (const auto& benchmark : benchmarks) {
+        if (filter.empty() || std::string(benchmark.name).find(filter) != std::string::npos) {
+            benchmark.run();
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return runBenchmarks(argc > 2 ? argv[2] : "");
+    }
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        return runHeadless(parseHeadlessOptions(argc, argv));
+    }
+    if (argc > 1 && std::string(argv[1]) == "--check-allocations") {
+        return runAllocationCheck();
+    }
 
-int main() {
     // --- 1. Window Setup ---
     // Create an SFML window object. This is our drawing canvas.
     // Arguments: VideoMode (width, height, bitsPerPixel), Title String
@@ -15,9 +1481,8 @@ int main() {
     window.setFramerateLimit(60); // Limit the frame rate to 60 FPS for smoother animation
 
     // --- 2. Shape Creation and Data Storage ---
-    // We'll draw many lines to form our starburst. A vector is a dynamic array
-    // that can grow or shrink as needed, perfect for storing multiple shapes.
-    std::vector<sf::Vertex> starburstVertices;
+    // We'll draw many lines to form our starburst. The vertices are generated once
+    // and handed to a PatternGeometry, which uploads them to the GPU.
 
     // Define the center of our starburst pattern.
     float centerX = 400.0f; // Half of the window width
@@ -30,45 +1495,153 @@ int main() {
     float rayLength = 200.0f;
 
     // --- 3. Generating the Starburst Pattern ---
-    // This is where the algorithm for creating the pattern comes in.
-    // We'll use a loop to draw each ray.
-    for (int i = 0; i < numberOfRays; ++i) {
-        // Calculate the angle for the current ray.
-        // We divide the full circle (2 * PI radians) by the number of rays
-        // to get the angular separation between each ray.
-        float angle = static_cast<float>(i) * (2.0f * M_PI) / static_cast<float>(numberOfRays);
+    // The starburst is the first of the pattern engine's generators. Command-line
+    // options (see parsePatternArgument) can pick another pattern or change its settings.
+    const PatternGenerator* pattern = &patternGenerators[0];
+    PatternSettings settings;
+    settings.center = center;
+    settings.count = numberOfRays;
+    settings.size = rayLength;
+    bool continuousOption = false; // --continuous: redraw every frame (see below).
+    bool showTimings = false;      // --overlay: start with the frame-time graph shown.
+    std::string timingsPath;       // --timings FILE: save frame times there on exit.
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--continuous") {
+            continuousOption = true;
+        } else if (std::string(argv[i]) == "--overlay") {
+            showTimings = true;
+        } else if (std::string(argv[i]) == "--timings" && i + 1 < argc) {
+            timingsPath = argv[++i];
+        } else if (!parsePatternArgument(argc, argv, i, pattern, settings)) {
+            std::cerr << "ignoring unknown option '" << argv[i] << "'" << std::endl;
+        }
+    }
+    // Big patterns are generated on all cores (see writePattern).
+    WorkerPool pool;
+    PatternGeometry starburst(generatePattern(*pattern, settings, &pool));
 
-        // Calculate the end point of the ray using trigonometry (cosine for x, sine for y).
-        // sf::Vector2f is useful here as it has x and y components.
-        sf::Vector2f rayEndPoint;
-        rayEndPoint.x = center.x + rayLength * std::cos(angle); // x = center.x + length * cos(angle)
-        rayEndPoint.y = center.y + rayLength * std::sin(angle); // y = center.y + length * sin(angle)
+    // Press A to start or pause the animation (rotation, pulsing and color cycling).
+    // The animation only changes how the starburst is drawn, never its vertices.
+    StarburstAnimation animation(center);
+    bool animating = false;
+    bool animationStarted = false; // Until then, draw the starburst as generated.
+    float animationTime = 0.0f;
+    sf::Clock frameClock;
 
-        // Create two sf::Vertex objects to define a line.
-        // sf::Vertex requires a position and an optional color.
-        sf::Vertex startVertex(center, sf::Color::White);   // The starting point of the ray is the center
-        sf::Vertex endVertex(rayEndPoint, sf::Color::White); // The ending point is calculated above
+    // A still pattern looks the same every frame, so by default the loop sleeps in
+    // waitEvent and only redraws when something "damages" the picture: a resize,
+    // the window coming back to the front (SFML has no expose event, so gaining
+    // focus stands in for it), or a change to the pattern. While animating, or
+    // with --continuous, it redraws every frame at up to 60 FPS as before.
+    const bool continuous = continuousOption;
+    bool needsRedraw = true;     // The first frame always has to be drawn.
+    bool patternChanged = false; // Regenerate the pattern before the next frame.
 
-        // Add these two vertices to our vector.
-        // SFML can draw primitives using a sequence of vertices.
-        // If we add pairs of vertices, SFML will draw lines connecting them.
-        starburstVertices.push_back(startVertex);
-        starburstVertices.push_back(endVertex);
-    }
+    // Frame timings, and the lines of their graph (press T to show or hide it).
+    FrameTimer timer;
+    std::vector<sf::Vertex> timingGraph;
+
+    // --- 5. Event Handling ---
+    // This checks for user input and window events, and notes whether the window
+    // needs to be redrawn.
+    auto handleEvent = [&](const sf::Event& event) {
+        // If the user clicks the close button (X), close the window.
+        if (event.type == sf::Event::Closed) {
+            window.close();
+        }
+        if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus) {
+            needsRedraw = true;
+        }
+        // Keyboard presses: A toggles the animation; T the frame-time graph; 1-6 pick
+        // a pattern, Up/Down double or halve its count, and Left/Right change its detail.
+        if (event.type == sf::Event::KeyPressed) {
+            const PatternGenerator* previousPattern = pattern;
+            const PatternSettings previousSettings = settings;
+            const int number = event.key.code - sf::Keyboard::Num1;
+            if (event.key.code == sf::Keyboard::A) {
+                animating = !animating;
+                animationStarted = true;
+                needsRedraw = true;
+                frameClock.restart(); // Don't count the time spent paused.
+            } else if (event.key.code == sf::Keyboard::T) {
+                showTimings = !showTimings;
+                needsRedraw = true;
+            } else if (number >= 0 && number < static_cast<int>(patternGeneratorCount)) {
+                pattern = &patternGenerators[number];
+            } else if (event.key.code == sf::Keyboard::Up) {
+                settings.count = std::min(settings.count, 1 << 24) * 2;
+            } else if (event.key.code == sf::Keyboard::Down) {
+                settings.count = std::max(1, settings.count / 2);
+            } else if (event.key.code == sf::Keyboard::Right) {
+                settings.detail += 1;
+            } else if (event.key.code == sf::Keyboard::Left) {
+                settings.detail = std::max(0, settings.detail - 1);
+            }
+            const bool changed = pattern != previousPattern || settings.count != previousSettings.count ||
+                                 settings.detail != previousSettings.detail;
+            if (changed && !patternFits(*pattern, settings)) {
+                // Too big to generate: keep showing the current pattern.
+                std::cout << pattern->name << ": more than " << MaxPatternSegments << " segments; not changed"
+                          << std::endl;
+                pattern = previousPattern;
+                settings = previousSettings;
+            } else if (changed) {
+                patternChanged = true;
+                needsRedraw = true;
+            }
+        }
+    };
+
+    // Process CPU time against wall-clock time shows how busy the loop keeps the
+    // machine; it is printed when the window closes.
+    const std::clock_t cpuStart = std::clock();
+    const auto wallStart = std::chrono::steady_clock::now();
+    long framesDrawn = 0;
 
     // --- 4. The Main Game Loop ---
-    // This loop runs continuously as long as the window is open.
+    // This loop runs as long as the window is open.
     while (window.isOpen()) {
-        // --- 5. Event Handling ---
-        // This section checks for user input and window events.
         sf::Event event;
-        while (window.pollEvent(event)) {
-            // If the user clicks the close button (X), close the window.
-            if (event.type == sf::Event::Closed) {
-                window.close();
+        if (continuous || animating || needsRedraw) {
+            // Handle whatever has happened since the last frame, without waiting:
+            // a frame is due anyway (this includes the very first one).
+            timer.start();
+            while (window.pollEvent(event)) {
+                handleEvent(event);
             }
-            // You could add more event handling here (e.g., keyboard presses)
+        } else if (window.waitEvent(event)) {
+            // Sleep until an event arrives, then handle it and any that came with it.
+            // (The frame is timed from here: the time asleep is not part of it.)
+            timer.start();
+            handleEvent(event);
+            while (window.pollEvent(event)) {
+                handleEvent(event);
+            }
+        }
+        if (!window.isOpen() || !(continuous || animating || needsRedraw)) {
+            continue; // Nothing on screen has changed.
         }
+        needsRedraw = false;
+        timer.lap(FrameTimer::Poll);
+
+        // Update the geometry: regenerate the pattern if it changed, and advance
+        // the animation by the time since the last frame.
+        if (patternChanged) {
+            patternChanged = false;
+            starburst.regenerate(*pattern, settings, &pool);
+            std::cout << pattern->name << ": count " << settings.count << ", detail " << settings.detail << " ("
+                      << pattern->parameters << "), " << starburst.vertexCount() << " vertices" << std::endl;
+        }
+        float frameSeconds = frameClock.restart().asSeconds();
+        if (animating) {
+            animationTime += frameSeconds;
+        }
+        animation.setTime(animationTime);
+        const sf::RenderStates states = animationStarted ? animation.prepare(starburst) : sf::RenderStates::Default;
+        if (showTimings) {
+            timer.writeGraph(timingGraph, sf::Vector2f(10.0f, 590.0f), 240, 6.0f);
+        }
+        timer.lap(FrameTimer::Update);
 
         // --- 6. Drawing ---
         // Clear the window with a background color (e.g., black) each frame.
@@ -76,17 +1649,36 @@ int main() {
         window.clear(sf::Color::Black);
 
         // Draw our starburst pattern.
-        // The draw function takes an SFML drawable object.
-        // We can pass a pointer to our vector and specify the primitive type (lines).
-        window.draw(starburstVertices.data(), starburstVertices.size(), sf::Lines);
+        // PatternGeometry is an sf::Drawable, so the window can draw it directly: a
+        // single draw call from the GPU-side vertex buffer (or, where vertex buffers
+        // are not supported, from our vector as before). Once animated, the render
+        // states carry the rotation, pulse and color for this frame.
+        window.draw(starburst, states);
+        if (showTimings) {
+            window.draw(timingGraph.data(), timingGraph.size(), sf::Lines);
+        }
+        timer.lap(FrameTimer::Draw);
 
         // Display the contents of the window.
         // Everything drawn in the frame is now shown on the screen.
         window.display();
+        timer.lap(FrameTimer::Display);
+        timer.finish();
+        ++framesDrawn;
     }
 
     // --- 7. End of Program ---
     // The program exits when the window is closed.
+    const double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    const std::chrono::duration<double> wallSeconds = std::chrono::steady_clock::now() - wallStart;
+    std::cout << framesDrawn << " frames drawn in " << wallSeconds.count() << " s; CPU time " << cpuSeconds
+              << " s (" << 100.0 * cpuSeconds / wallSeconds.count() << "% of one core)" << std::endl;
+    std::cout << "average of the last " << timer.size() << " frames: poll " << timer.average(FrameTimer::Poll)
+              << " ms, update " << timer.average(FrameTimer::Update) << " ms, draw " << timer.average(FrameTimer::Draw)
+              << " ms, display " << timer.average(FrameTimer::Display) << " ms" << std::endl;
+    if (!timingsPath.empty() && !timer.writeCsv(timingsPath)) {
+        std::cerr << "could not write " << timingsPath << std::endl;
+    }
     return 0;
 }
 
@@ -110,4 +1702,46 @@ Example Usage:
 
    A window should appear displaying a starburst pattern centered in the window.
    You can experiment by changing `numberOfRays` and `rayLength` to see how the pattern changes.
+   Press A to animate the starburst (and again to pause it).
+   While nothing moves, the window is only redrawn when needed (resize, focus,
+   pattern change) and the program sleeps in between; run with --continuous to
+   redraw at 60 FPS regardless. On exit it prints the frames drawn and the CPU
+   time used, so the two modes can be compared.
+   Press T (or start with --overlay) to show a graph of the last 240 frame
+   times in the bottom-left corner: each column stacks event handling (blue),
+   geometry update (green), draw calls (yellow) and display (red, which includes
+   the wait for the 60 FPS limit); the grey line is 1/60 s. With
+   --timings frames.csv the times of the last 3600 frames are saved on exit.
+   Keys 1-6 switch between the patterns (starburst, spiral, rose, lissajous,
+   polygons, koch); Up/Down double or halve their count and Left/Right change
+   their detail. The pattern can also be chosen on the command line:
+   ./starburst_pattern --pattern rose --count 2000 --detail 7
+   and "--bench patterns" measures how fast each one is generated. Large
+   patterns are generated on all cores; "--bench parallel" shows how generation
+   time scales from 1 thread to all of them.
+
+4. Benchmarks: run with --bench to time the demo instead (add a name, e.g.
+   "--bench retained", to run just one):
+   ./starburst_pattern --bench retained
+   compares frame times of client-side drawing and a GPU vertex buffer at
+   36, 10,000 and 1,000,000 rays. The OpenGL library must be linked as well:
+   add -lGL on Linux (or -lopengl32 on Windows) to the compile command.
+
+5. Headless: on a machine without a display (a build server, CI), run
+   ./starburst_pattern --headless 600 --rays 10000 --save frame.png
+   to render 600 frames off-screen and print frame-time percentiles and
+   pixels/second. Without a display (or with --cpu) the frames are drawn by the
+   software rasterizer instead of the GPU, and a hash of the last frame is
+   printed. Build with -O2 -mavx2 -pthread for its SIMD and multithreaded paths;
+   "--bench raster" measures its throughput in lines/second. Add --animate to
+   render the animation instead of the still starburst.
+
+6. Animation: "--bench animation" compares the CPU time per frame of animating
+   through a transform and shader uniform, recoloring vertices in place, and
+   regenerating all vertices, at up to 1,000,000 rays.
+
+7. Allocation check: ./starburst_pattern --check-allocations
+   regenerates and draws every pattern for 120 frames at alternating sizes and
+   prints how many heap allocations those frames made (expected: 0 each). The
+   exit status is 1 if any did, so it can run as a CI check.
 */
\ No newline at end of file
@@ -13,101 +13,4721 @@
 #include <map>        // For std::map, to store event listeners keyed by event type
 #include <vector>     // For std::vector, to store multiple listeners for a single event type
 #include <memory>     // Although not strictly used in this simplified version, useful for modern C++ resources
+#include <string>     // For std::string payload fields
+#include <typeinfo>   // For typeid(...).name() in the log messages
+#include <unordered_map> // For the symbol table and per-thread lookup caches
+#include <cstdint>    // For fixed-width integer types (std::uint32_t, std::int64_t)
+#include <cstddef>    // For std::size_t
+#include <chrono>     // For timing the benchmarks
+#include <algorithm>  // For std::min / std::max
+#include <atomic>     // For std::atomic (lock-free symbol lookups, allocation counting)
+#include <mutex>      // For std::mutex guarding symbol table inserts
+#include <stdexcept>  // For std::length_error, std::logic_error and std::invalid_argument
+#include <cstdlib>    // For std::malloc / std::free in the counting operator new
+#include <new>        // For std::bad_alloc and placement new
+#include <thread>     // For the timer thread and the multi-producer benchmarks
+#include <deque>      // For stable-address timer storage in the timing wheel
+#include <condition_variable> // For waking and stopping the timer thread
+#include <optional>   // For the response stored inside a QueryFuture
+#include <fstream>    // For writing Chrome trace files
+#include <filesystem> // For std::filesystem::temp_directory_path in the benchmarks
+#include <cstring>    // For std::memcpy in the event serializers
+#include <tuple>      // For std::tie / std::apply over reflected event fields
+#include <type_traits> // For the field-codec traits
+#include <utility>    // For std::index_sequence
+#include <system_error> // For std::system_error from the socket bridge
+#if defined(__linux__)
+#include <sys/socket.h> // For the event bridge sockets
+#include <sys/un.h>     // For sockaddr_un (Unix domain sockets)
+#include <sys/uio.h>    // For iovec (the bridge's gathered writes)
+#include <sys/epoll.h>  // For the bridge receiver's event loop
+#include <netinet/in.h> // For sockaddr_in (loopback TCP)
+#include <netinet/tcp.h> // For TCP_NODELAY
+#include <arpa/inet.h>  // For htons / htonl
+#include <unistd.h>     // For read / write / close / unlink / fdatasync / fsync
+#include <cerrno>       // For errno
+#include <fcntl.h>      // For open (journal segments)
+#include <sys/mman.h>   // For mmap (journal replay)
+#include <time.h>       // For CLOCK_MONOTONIC_COARSE (delivery-policy windows)
+#include <sys/stat.h>   // For fstat
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // For __rdtsc
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>    // For __rdtsc
+#endif
+
+// ListenerToken: returned by EventBus::subscribeScoped. The listener stays
+// subscribed for as long as the token (or a copy of it) is alive; destroying the
+// token, or calling unsubscribe(), retires the listener.
+class ListenerToken {
+private:
+    std::shared_ptr<void> lifetime;
+
+public:
+    ListenerToken() = default;
+    explicit ListenerToken(std::shared_ptr<void> lifetime) : lifetime(std::move(lifetime)) {}
+
+    void unsubscribe() { lifetime.reset(); }
+    bool active() const { return lifetime != nullptr; }
+};
+
+// DeliveryPolicy: decides, per subscription, which emitted events reach the handler.
+// Telemetry or UI listeners rarely need every PlayerMovedEvent; a policy lets them
+// be throttled at the bus without touching the code that emits.
+// - every()           : every event (the default).
+// - everyNth(n)       : the 1st, (n+1)th, (2n+1)th, ... event.
+// - maxPerSecond(n)   : at most n events in each one-second window.
+// - reservoir(k)      : reservoir sampling over one-second windows. The first k events
+//                       of a window are delivered; after that, the i-th event is
+//                       delivered with probability k/i (it replaces a reservoir slot),
+//                       so deliveries grow only logarithmically with the event rate
+//                       while every event has the same chance of being in the sample.
+struct DeliveryPolicy {
+    enum class Kind { Every, EveryNth, MaxPerSecond, Reservoir };
+
+    Kind kind = Kind::Every;
+    std::uint32_t n = 1;
+
+    static DeliveryPolicy every() { return {}; }
+    static DeliveryPolicy everyNth(std::uint32_t n) { return {Kind::EveryNth, std::max<std::uint32_t>(n, 1)}; }
+    static DeliveryPolicy maxPerSecond(std::uint32_t n) { return {Kind::MaxPerSecond, n}; }
+    static DeliveryPolicy reservoir(std::uint32_t k) { return {Kind::Reservoir, std::max<std::uint32_t>(k, 1)}; }
+};
+
+// TimerId: handle to a timer scheduled on a TimingWheel (see EventBus::emitAfter).
+// Handles carry a generation number, so cancelling a timer that already fired, or
+// whose slot has been reused, is a harmless no-op.
+struct TimerId {
+    std::uint32_t index = 0xFFFFFFFFu;
+    std::uint32_t generation = 0;
+};
+
+// TimingWheel: a hierarchical timing wheel counting time in integer ticks.
+//
+// Level 0 has one slot per tick for the next 256 ticks. Each higher level has 256
+// slots that each cover 256 slots of the level below it, so four levels span 2^32
+// ticks (about 49 days at 1 ms per tick). A timer is placed in the lowest level
+// whose range still contains its deadline, in a doubly linked list threaded through
+// the timer records themselves. That makes both schedule and cancel O(1): compute
+// a slot and link, or unlink.
+//
+// As time advances, whenever a level's slot index wraps around, the next slot of the
+// level above is "cascaded": its timers are re-linked into finer slots. Each timer
+// is cascaded at most once per level, so firing is amortized O(1) per timer too.
+class TimingWheel {
+public:
+    static constexpr unsigned LevelBits = 8;
+    static constexpr unsigned SlotsPerLevel = 1u << LevelBits;
+    static constexpr unsigned Levels = 4;
+
+private:
+    static constexpr std::uint32_t None = 0xFFFFFFFFu;
+    static constexpr std::uint32_t FiringList = Levels * SlotsPerLevel; // Extra list: timers being fired.
+
+    enum class State : std::uint8_t { Free, Pending, Firing, Cancelled };
+
+    struct Timer {
+        std::function<void()> action;
+        std::uint64_t deadline = 0; // Tick at which the timer fires.
+        std::uint64_t period = 0;   // Ticks between repeats; 0 for one-shot timers.
+        std::uint32_t prev = None;
+        std::uint32_t next = None;
+        std::uint32_t list = None;  // Index into 'heads' of the list this timer is in.
+        std::uint32_t generation = 0;
+        State state = State::Free;
+    };
+
+    // std::deque never moves existing elements when growing, so an action keeps a
+    // stable address even if it schedules new timers while it is running.
+    std::deque<Timer> timers;
+    std::vector<std::uint32_t> freeTimers;
+    std::uint32_t heads[Levels * SlotsPerLevel + 1];
+    std::size_t levelCounts[Levels + 1] = {}; // Timers filed under each level (+ firing list).
+    std::uint64_t currentTick = 0;
+    std::size_t pendingCount = 0;
+
+    void pushFront(std::uint32_t list, std::uint32_t index) {
+        Timer& timer = timers[index];
+        ++levelCounts[list / SlotsPerLevel];
+        timer.list = list;
+        timer.prev = None;
+        timer.next = heads[list];
+        if (timer.next != None) {
+            timers[timer.next].prev = index;
+        }
+        heads[list] = index;
+    }
+
+    void unlink(std::uint32_t index) {
+        Timer& timer = timers[index];
+        if (timer.prev != None) {
+            timers[timer.prev].next = timer.next;
+        } else {
+            heads[timer.list] = timer.next;
+        }
+        if (timer.next != None) {
+            timers[timer.next].prev = timer.prev;
+        }
+        --levelCounts[timer.list / SlotsPerLevel];
+        timer.prev = timer.next = timer.list = None;
+    }
+
+    // link(index): files a pending timer under the lowest level whose current
+    // rotation contains its deadline (its deadline agrees with the current tick on
+    // every bit above that level).
+    void link(std::uint32_t index) {
+        const std::uint64_t deadline = timers[index].deadline;
+        for (unsigned level = 0; level < Levels; ++level) {
+            const unsigned shift = LevelBits * (level + 1);
+            if ((deadline >> shift) == (currentTick >> shift)) {
+                const std::uint32_t slot = static_cast<std::uint32_t>((deadline >> (LevelBits * level)) & (SlotsPerLevel - 1));
+                pushFront(level * SlotsPerLevel + slot, index);
+                return;
+            }
+        }
+        // Beyond the wheel's range: park it in top-level slot 0, which is cascaded
+        // when the whole wheel wraps around. It is then re-filed, never fired early.
+        pushFront((Levels - 1) * SlotsPerLevel, index);
+    }
+
+    void cascade(unsigned level) {
+        const std::uint32_t list = level * SlotsPerLevel +
+            static_cast<std::uint32_t>((currentTick >> (LevelBits * level)) & (SlotsPerLevel - 1));
+        std::uint32_t index = heads[list];
+        heads[list] = None;
+        while (index != None) {
+            std::uint32_t next = timers[index].next;
+            --levelCounts[level];
+            link(index);
+            index = next;
+        }
+    }
+
+    void release(std::uint32_t index) {
+        Timer& timer = timers[index];
+        timer.action = nullptr;
+        timer.state = State::Free;
+        ++timer.generation;
+        freeTimers.push_back(index);
+    }
+
+    // fireCurrentSlot(): runs every timer due at 'currentTick'.
+    void fireCurrentSlot() {
+        const std::uint32_t list = static_cast<std::uint32_t>(currentTick & (SlotsPerLevel - 1));
+        // Move the slot's timers to the firing list first, so actions that cancel
+        // other due timers still find them in a well-formed list.
+        heads[FiringList] = heads[list];
+        heads[list] = None;
+        for (std::uint32_t index = heads[FiringList]; index != None; index = timers[index].next) {
+            timers[index].list = FiringList;
+            --levelCounts[0];
+            ++levelCounts[Levels];
+        }
+
+        while (heads[FiringList] != None) {
+            const std::uint32_t index = heads[FiringList];
+            unlink(index);
+            Timer& timer = timers[index];
+            timer.state = State::Firing;
+            --pendingCount;
+            timer.action();
+            if (timer.state == State::Firing && timer.period != 0) {
+                timer.deadline += timer.period;
+                timer.state = State::Pending;
+                ++pendingCount;
+                link(index);
+            } else {
+                release(index);
+            }
+        }
+    }
+
+public:
+    TimingWheel() {
+        std::fill(std::begin(heads), std::end(heads), None);
+    }
+
+    std::uint64_t now() const { return currentTick; }
+    std::size_t pending() const { return pendingCount; }
+
+    // schedule(deadline, period, action): runs 'action' at tick 'deadline' (or on
+    // the next tick if that is already past), then every 'period' ticks if period > 0.
+    TimerId schedule(std::uint64_t deadline, std::uint64_t period, std::function<void()> action) {
+        std::uint32_t index;
+        if (!freeTimers.empty()) {
+            index = freeTimers.back();
+            freeTimers.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(timers.size());
+            timers.emplace_back();
+        }
+        Timer& timer = timers[index];
+        timer.action = std::move(action);
+        timer.deadline = std::max(deadline, currentTick + 1);
+        timer.period = period;
+        timer.state = State::Pending;
+        ++pendingCount;
+        link(index);
+        return TimerId{index, timer.generation};
+    }
+
+    // cancel(id): stops a pending or repeating timer. Returns false if the timer
+    // already fired (one-shot) or was cancelled before.
+    bool cancel(TimerId id) {
+        if (id.index >= timers.size() || timers[id.index].generation != id.generation) {
+            return false;
+        }
+        Timer& timer = timers[id.index];
+        if (timer.state == State::Pending) {
+            unlink(id.index);
+            --pendingCount;
+            release(id.index);
+            return true;
+        }
+        if (timer.state == State::Firing) {
+            // Cancelled from inside its own action: released once the action returns.
+            timer.state = State::Cancelled;
+            return true;
+        }
+        return false;
+    }
+
+    // advance(tick): moves time forward to 'tick', firing everything due on the way.
+    void advance(std::uint64_t tick) {
+        while (currentTick < tick) {
+            if (pendingCount == 0) {
+                currentTick = tick; // Nothing to fire: jump straight there.
+                return;
+            }
+            // If the lowest occupied level is L > 0, nothing can fire before level L's
+            // next slot is cascaded, so skip straight to the tick before that boundary.
+            unsigned lowest = 0;
+            while (levelCounts[lowest] == 0) {
+                ++lowest;
+            }
+            if (lowest > 0) {
+                const std::uint64_t span = std::uint64_t(1) << (LevelBits * lowest);
+                const std::uint64_t boundary = (currentTick | (span - 1)) + 1;
+                currentTick = std::min(tick, boundary - 1);
+                if (currentTick == tick) {
+                    return;
+                }
+            }
+            ++currentTick;
+            for (unsigned level = Levels - 1; level > 0; --level) {
+                if ((currentTick & ((std::uint64_t(1) << (LevelBits * level)) - 1)) == 0) {
+                    cascade(level);
+                }
+            }
+            fireCurrentSlot();
+        }
+    }
+};
+
+// --- Latency Tracing ---
+// How long does an event spend between emit and each handler? When tracing is
+// enabled, every emit is stamped with the CPU's cycle counter (RDTSC on x86,
+// CNTVCT on ARM64, the steady clock elsewhere), and the stamp travels with the
+// event through queued paths (EventCollector records and Mailbox entries). Right
+// before a handler runs, the bus records "now - stamp" into a histogram for the
+// event type and appends a span to an in-memory trace that can be written out as
+// Chrome trace JSON (open it in chrome://tracing or https://ui.perfetto.dev).
+//
+// Recording is lock-free: histogram buckets are relaxed atomic counters, and trace
+// spans are claimed with one fetch_add on a fixed-size buffer (spans beyond its
+// capacity are counted as dropped). With tracing off, emit pays a single relaxed
+// load of the 'enabled' flag.
+
+// cycleCounter(): a cheap, monotonic (per core) timestamp in counter ticks.
+inline std::uint64_t cycleCounter() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    std::uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// LatencyHistogram: counts of latencies in power-of-two buckets of counter ticks.
+struct LatencyHistogram {
+    static constexpr int Buckets = 64;
+
+    std::atomic<std::uint64_t> buckets[Buckets] = {};
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> totalTicks{0};
+    std::atomic<std::uint64_t> maxTicks{0};
+
+    void record(std::uint64_t ticks) {
+        int bucket = 0; // floor(log2(ticks))
+        for (std::uint64_t rest = ticks >> 1; rest != 0; rest >>= 1) {
+            ++bucket;
+        }
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+        std::uint64_t seen = maxTicks.load(std::memory_order_relaxed);
+        while (ticks > seen && !maxTicks.compare_exchange_weak(seen, ticks, std::memory_order_relaxed)) {
+        }
+    }
+
+    // percentile(p): upper bound, in ticks, of the bucket holding the p-th percentile
+    // (never more than the largest latency seen).
+    std::uint64_t percentile(double p) const {
+        const std::uint64_t total = count.load(std::memory_order_relaxed);
+        const std::uint64_t largest = maxTicks.load(std::memory_order_relaxed);
+        const auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(total));
+        std::uint64_t seen = 0;
+        for (int bucket = 0; bucket < Buckets - 1; ++bucket) {
+            seen += buckets[bucket].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                return std::min(largest, (std::uint64_t(2) << bucket) - 1);
+            }
+        }
+        return largest;
+    }
+};
+
+class EventTracer {
+private:
+    struct Span {
+        const char* name;
+        std::uint32_t thread;
+        std::uint64_t origin;  // Emit stamp.
+        std::uint64_t start;   // Handler start.
+        std::uint64_t end;     // Handler end.
+    };
+
+    std::atomic<bool> enabled{false};
+    std::unique_ptr<Span[]> spans;
+    std::size_t spanCapacity = 0;
+    std::atomic<std::size_t> spanCount{0};
+    std::uint64_t baseTicks = 0;      // Counter value when tracing was first enabled.
+    double ticksPerMicrosecond = 1.0; // Calibrated against the steady clock.
+
+    std::mutex histogramMutex;        // Guards 'histograms' (registration only).
+    std::vector<std::pair<const char*, LatencyHistogram*>> histograms;
+
+    EventTracer() = default;
+
+    void calibrate() {
+        auto wallStart = std::chrono::steady_clock::now();
+        std::uint64_t tickStart = cycleCounter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::uint64_t ticks = cycleCounter() - tickStart;
+        std::chrono::duration<double, std::micro> wall = std::chrono::steady_clock::now() - wallStart;
+        ticksPerMicrosecond = static_cast<double>(ticks) / wall.count();
+    }
+
+    static std::uint32_t threadNumber() {
+        static std::atomic<std::uint32_t> next{1};
+        thread_local std::uint32_t number = next.fetch_add(1);
+        return number;
+    }
+
+public:
+    // instance(): the process-wide tracer (never destroyed, like EventPool).
+    static EventTracer& instance() {
+        static EventTracer* tracer = new EventTracer;
+        return *tracer;
+    }
+
+    // enable(spanCapacity): starts tracing, keeping up to 'spanCapacity' spans.
+    // Call it before emitting from other threads.
+    void enable(std::size_t capacity = 1 << 20) {
+        if (spanCapacity == 0) {
+            calibrate();
+            baseTicks = cycleCounter();
+            spans.reset(new Span[capacity]);
+            spanCapacity = capacity;
+        }
+        enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void disable() { enabled.store(false, std::memory_order_relaxed); }
+    bool active() const { return enabled.load(std::memory_order_relaxed); }
+
+    // stamp(): the emit timestamp for a new event, or 0 when tracing is off.
+    std::uint64_t stamp() const { return active() ? cycleCounter() : 0; }
+
+    double ticksToNanoseconds(std::uint64_t ticks) const { return static_cast<double>(ticks) * 1000.0 / ticksPerMicrosecond; }
+
+    // histogram<TEvent>(): the emit-to-handle histogram for TEvent.
+    template<typename TEvent>
+    LatencyHistogram& histogram() {
+        static LatencyHistogram* forType = [this] {
+            auto* created = new LatencyHistogram;
+            std::lock_guard<std::mutex> lock(histogramMutex);
+            histograms.emplace_back(typeid(TEvent).name(), created);
+            return created;
+        }();
+        return *forType;
+    }
+
+    // traced<TEvent>(origin, handler): runs 'handler', recording its latency from
+    // 'origin' (skipped when origin is 0, i.e. the event was not stamped).
+    template<typename TEvent, typename F>
+    void traced(std::uint64_t origin, F&& handler) {
+        if (origin == 0) {
+            handler();
+            return;
+        }
+        std::uint64_t start = cycleCounter();
+        handler();
+        std::uint64_t end = cycleCounter();
+        histogram<TEvent>().record(start > origin ? start - origin : 0);
+        std::size_t index = spanCount.fetch_add(1, std::memory_order_relaxed);
+        if (index < spanCapacity) {
+            spans[index] = Span{typeid(TEvent).name(), threadNumber(), origin, start, end};
+        }
+    }
+
+    // printSummary(out): per-type count and latency percentiles.
+    void printSummary(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(histogramMutex);
+        for (const auto& entry : histograms) {
+            const LatencyHistogram& h = *entry.second;
+            const std::uint64_t n = h.count.load();
+            if (n == 0) {
+                continue;
+            }
+            out << "  " << entry.first << ": " << n << " handled, mean "
+                << ticksToNanoseconds(h.totalTicks.load() / n) << " ns, p50 <= "
+                << ticksToNanoseconds(h.percentile(50)) << " ns, p99 <= " << ticksToNanoseconds(h.percentile(99))
+                << " ns, max " << ticksToNanoseconds(h.maxTicks.load()) << " ns" << std::endl;
+        }
+    }
+
+    // writeChromeTrace(path): writes the recorded spans as Chrome trace JSON. Each
+    // delivery becomes two complete ("X") events on its handler's thread: the
+    // wait from emit to handler start, and the handler itself.
+    bool writeChromeTrace(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        const std::size_t recorded = std::min(spanCount.load(), spanCapacity);
+        auto micros = [this](std::uint64_t ticks) {
+            return static_cast<double>(ticks - std::min(ticks, baseTicks)) / ticksPerMicrosecond;
+        };
+        out << "{\"traceEvents\":[";
+        for (std::size_t i = 0; i < recorded; ++i) {
+            const Span& span = spans[i];
+            out << (i ? ",\n" : "\n")
+                << "{\"name\":\"wait " << span.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+                << ",\"ts\":" << micros(span.origin) << ",\"dur\":" << (micros(span.start) - micros(span.origin))
+                << "},\n{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+                << ",\"ts\":" << micros(span.start) << ",\"dur\":" << (micros(span.end) - micros(span.start)) << "}";
+        }
+        out << "\n],\"otherData\":{\"droppedSpans\":" << (spanCount.load() - recorded) << "}}\n";
+        return static_cast<bool>(out);
+    }
+};
+
+// --- Pooled Event Storage ---
+// Queued and deferred delivery (scheduled emits, collected events, mailboxes) must
+// keep a copy of each event until every listener has seen it. Allocating those
+// copies with new or std::make_shared sends every event through the general-purpose
+// allocator, and a copy made on one thread is usually freed on another.
+//
+// EventPool<TEvent> is a free-list allocator dedicated to one event type:
+// - Each thread has its own cache of free slots, so acquiring and releasing on the
+//   same thread is a couple of pointer moves with no synchronization.
+// - A slot released on a different thread is pushed onto its home cache's
+//   lock-free "remote" stack; the home thread takes the whole stack back in a
+//   single exchange when its local list runs dry.
+// - When a cache is empty it grows by a chunk as large as everything it already
+//   owns (at least MinChunk), so capacity converges on the observed peak traffic.
+// - Slots are reference counted: a slot returns to the pool only once the last
+//   EventPool<TEvent>::Ref to it (one per pending delivery) is gone.
+template<typename TEvent>
+class EventPool {
+private:
+    struct Cache;
+
+    struct Slot {
+        alignas(TEvent) unsigned char storage[sizeof(TEvent)];
+        std::atomic<std::uint32_t> refs{0};
+        Cache* home = nullptr; // The cache this slot is returned to.
+        Slot* next = nullptr;  // Free-list link.
+
+        TEvent* event() { return std::launder(reinterpret_cast<TEvent*>(storage)); }
+    };
+
+    // Cache: one thread's free slots. Only the owning thread touches 'local' and
+    // writes 'acquires' and 'hits'; other threads only push onto 'remote' and count
+    // those pushes in 'remoteReturns'.
+    struct Cache {
+        Slot* local = nullptr;
+        std::atomic<Slot*> remote{nullptr};
+        std::size_t owned = 0; // Slots allocated by this cache's chunks.
+        std::atomic<std::uint64_t> acquires{0};
+        std::atomic<std::uint64_t> hits{0};          // Served from a free list.
+        std::atomic<std::uint64_t> remoteReturns{0}; // Slots other threads returned to this cache.
+
+        void count(std::atomic<std::uint64_t>& counter) {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+
+    static constexpr std::size_t MinChunk = 64;
+    static constexpr std::size_t MaxChunk = 65536;
+
+    std::mutex registryMutex;                    // Guards the three vectors below.
+    std::vector<std::unique_ptr<Cache>> caches;
+    std::vector<Cache*> unownedCaches;           // Left behind by threads that exited.
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    std::atomic<std::size_t> capacity{0};        // Slots across all chunks.
+
+    // CacheOwner: gives the calling thread a cache on first use and hands the cache
+    // (with any free slots in it) back for adoption when the thread exits.
+    struct CacheOwner {
+        Cache* cache = nullptr;
+        ~CacheOwner() {
+            if (cache != nullptr) {
+                EventPool& pool = instance();
+                std::lock_guard<std::mutex> lock(pool.registryMutex);
+                pool.unownedCaches.push_back(cache);
+            }
+        }
+    };
+
+    static CacheOwner& owner() {
+        thread_local CacheOwner current;
+        return current;
+    }
+
+    Cache& localCache() {
+        CacheOwner& current = owner();
+        if (current.cache == nullptr) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            if (!unownedCaches.empty()) {
+                current.cache = unownedCaches.back();
+                unownedCaches.pop_back();
+            } else {
+                caches.push_back(std::make_unique<Cache>());
+                current.cache = caches.back().get();
+            }
+        }
+        return *current.cache;
+    }
+
+    // grow(cache): allocates a new chunk for 'cache' and links it into its free list.
+    void grow(Cache& cache) {
+        const std::size_t size = std::min(MaxChunk, std::max(MinChunk, cache.owned));
+        std::unique_ptr<Slot[]> chunk(new Slot[size]);
+        for (std::size_t i = 0; i < size; ++i) {
+            chunk[i].home = &cache;
+            chunk[i].next = i + 1 < size ? &chunk[i + 1] : cache.local;
+        }
+        cache.local = &chunk[0];
+        cache.owned += size;
+        capacity.fetch_add(size, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        chunks.push_back(std::move(chunk));
+    }
+
+    static void release(Slot* slot) {
+        if (slot->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return; // Other deliveries still reference this event.
+        }
+        slot->event()->~TEvent();
+        Cache* mine = owner().cache;
+        Cache* home = slot->home;
+        if (home == mine) {
+            slot->next = home->local;
+            home->local = slot;
+            return;
+        }
+        // Lock-free push onto the home cache's remote stack. The home thread only
+        // ever takes the entire stack at once, so there is no ABA hazard.
+        Slot* head = home->remote.load(std::memory_order_relaxed);
+        do {
+            slot->next = head;
+        } while (!home->remote.compare_exchange_weak(head, slot, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+        // Counted on the home cache: the releasing thread (typically a mailbox
+        // consumer that never acquires) may not have a cache of its own.
+        home->remoteReturns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    EventPool() = default;
+
+public:
+    // Ref: a counted reference to a pooled event. Copying a Ref adds a reference;
+    // the slot is recycled when the last Ref is destroyed, on whatever thread.
+    class Ref {
+    private:
+        Slot* slot = nullptr;
+        friend class EventPool;
+        explicit Ref(Slot* slot) : slot(slot) {}
+
+    public:
+        Ref() = default;
+        Ref(const Ref& other) : slot(other.slot) {
+            if (slot != nullptr) {
+                slot->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        Ref(Ref&& other) noexcept : slot(other.slot) { other.slot = nullptr; }
+        Ref& operator=(Ref other) noexcept {
+            std::swap(slot, other.slot);
+            return *this;
+        }
+        ~Ref() {
+            if (slot != nullptr) {
+                release(slot);
+            }
+        }
+
+        // detach()/attach(): turn a Ref into an opaque pointer and back, for queues
+        // that store events of many types side by side. The reference is carried
+        // over, not copied.
+        void* detach() {
+            Slot* detached = slot;
+            slot = nullptr;
+            return detached;
+        }
+        static Ref attach(void* detached) { return Ref(static_cast<Slot*>(detached)); }
+
+        const TEvent& operator*() const { return *slot->event(); }
+        const TEvent* operator->() const { return slot->event(); }
+        explicit operator bool() const { return slot != nullptr; }
+    };
+
+    struct Stats {
+        std::uint64_t acquires = 0;
+        std::uint64_t hits = 0;          // Acquires served without growing the pool.
+        std::uint64_t remoteReturns = 0; // Releases that crossed threads.
+        std::size_t capacity = 0;        // Slots allocated, i.e. the peak footprint.
+        std::size_t footprintBytes = 0;
+
+        double hitRate() const { return acquires ? static_cast<double>(hits) / acquires : 0.0; }
+    };
+
+    // instance(): the pool for TEvent. Deliberately never destroyed, so events still
+    // referenced during static destruction remain valid.
+    static EventPool& instance() {
+        static EventPool* pool = new EventPool;
+        return *pool;
+    }
+
+    // acquire(event): copies 'event' into a pooled slot and returns the first Ref.
+    Ref acquire(const TEvent& event) {
+        Cache& cache = localCache();
+        cache.count(cache.acquires);
+        Slot* slot = cache.local;
+        if (slot == nullptr) {
+            slot = cache.remote.exchange(nullptr, std::memory_order_acquire);
+        }
+        if (slot != nullptr) {
+            cache.count(cache.hits);
+        } else {
+            grow(cache);
+            slot = cache.local;
+        }
+        cache.local = slot->next;
+        new (slot->storage) TEvent(event);
+        slot->refs.store(1, std::memory_order_relaxed);
+        return Ref(slot);
+    }
+
+    // stats(): totals across all threads (approximate while threads are active).
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        Stats result;
+        for (const auto& cache : caches) {
+            result.acquires += cache->acquires.load(std::memory_order_relaxed);
+            result.hits += cache->hits.load(std::memory_order_relaxed);
+            result.remoteReturns += cache->remoteReturns.load(std::memory_order_relaxed);
+        }
+        result.capacity = capacity.load(std::memory_order_relaxed);
+        result.footprintBytes = result.capacity * sizeof(Slot);
+        return result;
+    }
+};
+
+// Backpressure: how a mailbox subscription behaves when its consumer falls behind.
+// 'credits' is the subscription's window: the most deliveries it may have queued
+// but not yet handled (0 means only the mailbox's capacity limits it). When the
+// window (or the mailbox) is full, the overflow policy decides what emit does:
+// - Shed     : drop the event for this subscription.
+// - Coalesce : keep only the newest overflowing event; it is handed to the
+//              consumer as soon as one of its queued deliveries completes.
+// - Block    : wait until the consumer frees a credit (emit's default behaviour).
+//              Only the consumer can free one, so a handler running inside drain()
+//              must not emit into a full Block subscription of its own mailbox:
+//              that emit throws std::logic_error instead of waiting forever.
+struct Backpressure {
+    enum class Overflow { Shed, Coalesce, Block };
+
+    std::uint32_t credits = 0;
+    Overflow overflow = Overflow::Block;
+
+    static Backpressure shed(std::uint32_t credits) { return {credits, Overflow::Shed}; }
+    static Backpressure coalesce(std::uint32_t credits) { return {credits, Overflow::Coalesce}; }
+    static Backpressure block(std::uint32_t credits) { return {credits, Overflow::Block}; }
+};
+
+// EmitResult: what EventBus::emit did with one event, so producers can notice that
+// a downstream listener is saturated without any extra calls.
+struct EmitResult {
+    std::uint32_t called = 0;    // Handlers run directly on the emitting thread.
+    std::uint32_t queued = 0;    // Deliveries enqueued to mailboxes.
+    std::uint32_t shed = 0;      // Deliveries dropped by a Shed subscription.
+    std::uint32_t coalesced = 0; // Deliveries folded into a Coalesce subscription's newest slot.
+    std::uint32_t blocked = 0;   // Deliveries that had to wait for a Block subscription.
+    std::uint32_t rejected = 0;  // tryEmit only: deliveries a Block subscription
+                                 // refused instead of waiting for credit.
+
+    bool saturated() const { return shed || coalesced || blocked || rejected; }
+};
+
+// --- Mailboxes: Delivering on the Subscriber's Thread ---
+// A plain subscription runs its handler on whichever thread calls emit, so every
+// handler has to be thread-safe and its state bounces between the caches of all
+// emitting cores. A Mailbox belongs to one consumer thread instead (an "actor"):
+// subscriptions bound to it only enqueue the event, and the owning thread runs the
+// handlers itself, in batches, whenever it calls drain(). Handler state is then
+// only ever touched by that one thread.
+//
+// The inbox is a bounded multi-producer/single-consumer ring (Dmitry Vyukov's
+// design): producers claim a cell with one compare-and-swap on the tail and publish
+// it with a per-cell sequence number, and the consumer needs no atomic
+// read-modify-write at all. Entries hold a pooled Ref to the event, so an event
+// posted to several mailboxes is copied once and recycled after the last of them
+// has handled it.
+class Mailbox {
+private:
+    // Target: one subscription's handler. Targets are owned by the mailbox and kept
+    // until it is destroyed, so queued entries can never outlive their handler.
+    //
+    // Each target also carries its credit window and the counters behind stats().
+    struct TargetBase {
+        virtual ~TargetBase() = default;
+
+        void (*run)(TargetBase*, void*, std::uint64_t) = nullptr; // Mailbox::run<TEvent>.
+        const char* eventName = "";
+        Backpressure backpressure;
+        std::atomic<std::uint32_t> inFlight{0};   // Queued or running deliveries.
+        std::atomic<void*> newest{nullptr};       // Coalesce: the parked newest event.
+        std::atomic<std::uint32_t> peakDepth{0};
+        std::atomic<std::uint64_t> delivered{0};  // Written by the consumer only.
+        std::atomic<std::uint64_t> shed{0};
+        std::atomic<std::uint64_t> coalesced{0};
+        std::atomic<std::uint64_t> blocked{0};
+
+        // reserveCredit(): claims one credit, or returns false if the window is full.
+        bool reserveCredit() {
+            const std::uint32_t credits = backpressure.credits;
+            std::uint32_t depth = inFlight.load();
+            do {
+                if (credits != 0 && depth >= credits) {
+                    return false;
+                }
+            } while (!inFlight.compare_exchange_weak(depth, depth + 1));
+            if (depth + 1 > peakDepth.load(std::memory_order_relaxed)) {
+                peakDepth.store(depth + 1, std::memory_order_relaxed); // Approximate under races.
+            }
+            return true;
+        }
+
+        bool hasCredit() const {
+            return backpressure.credits == 0 || inFlight.load() < backpressure.credits;
+        }
+    };
+
+    template<typename TEvent>
+    struct Target final : TargetBase {
+        std::function<void(const TEvent&)> handler;
+        std::weak_ptr<void> owner; // Checked again at delivery for owner-bound subscriptions.
+        bool bound = false;
+    };
+
+    struct Entry {
+        std::atomic<std::size_t> sequence{0};
+        void (*run)(TargetBase*, void*, std::uint64_t) = nullptr; // Calls the handler (unless the
+                                                                  // target is null), then drops the event.
+        TargetBase* target = nullptr;
+        void* event = nullptr;                     // A detached EventPool<TEvent>::Ref.
+        std::uint64_t origin = 0;                  // Emit stamp, when tracing.
+    };
+
+    std::unique_ptr<Entry[]> ring;
+    const std::size_t mask;
+    alignas(64) std::atomic<std::size_t> tail{0}; // Producers.
+    alignas(64) std::atomic<std::size_t> head{0}; // Written by the consumer only.
+
+    std::mutex targetMutex;
+    std::vector<std::unique_ptr<TargetBase>> targets;
+
+    // Subscriptions are bound to this token, so the bus forgets them when the
+    // mailbox is destroyed. An emit holds a locked copy of it for as long as it is
+    // posting here, which is what the destructor waits for.
+    std::shared_ptr<char> alive = std::make_shared<char>();
+
+    // The thread inside drain(), if any; a Block wait on that thread could never end.
+    std::atomic<std::thread::id> consumer{};
+
+    // Set by the destructor: posters stop waiting for credit and give up.
+    std::atomic<bool> closing{false};
+
+    friend class EventBus;
+
+    template<typename TEvent>
+    static void run(TargetBase* base, void* event, std::uint64_t origin) {
+        auto pooled = EventPool<TEvent>::Ref::attach(event);
+        if (base == nullptr) {
+            return;
+        }
+        auto& target = static_cast<Target<TEvent>&>(*base);
+        std::shared_ptr<void> owner;
+        if (target.bound && !(owner = target.owner.lock())) {
+            return;
+        }
+        EventTracer::instance().traced<TEvent>(origin, [&] { target.handler(*pooled); });
+    }
+
+    template<typename TEvent>
+    Target<TEvent>* addTarget(std::function<void(const TEvent&)> handler, std::weak_ptr<void> owner, bool bound,
+                              Backpressure backpressure) {
+        auto target = std::make_unique<Target<TEvent>>();
+        target->handler = std::move(handler);
+        target->owner = std::move(owner);
+        target->bound = bound;
+        target->run = &Mailbox::run<TEvent>;
+        target->eventName = typeid(TEvent).name();
+        target->backpressure = backpressure;
+        std::lock_guard<std::mutex> lock(targetMutex);
+        targets.push_back(std::move(target));
+        return static_cast<Target<TEvent>*>(targets.back().get());
+    }
+
+    // tryPost(target, event): enqueues one delivery. Returns false if the ring is full.
+    template<typename TEvent>
+    bool tryPost(TargetBase* target, const typename EventPool<TEvent>::Ref& event, std::uint64_t origin) {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        Entry* entry;
+        for (;;) {
+            entry = &ring[position & mask];
+            std::size_t sequence = entry->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false; // Full: the consumer has not freed this cell yet.
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+        entry->run = &Mailbox::run<TEvent>;
+        entry->target = target;
+        entry->event = typename EventPool<TEvent>::Ref(event).detach();
+        entry->origin = origin;
+        entry->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // post(target, event, origin, result, wait): enqueues one delivery within the
+    // target's credit window, applying its overflow policy when the window or the
+    // ring is full. With 'wait' false, Block rejects the delivery instead of waiting.
+    // The outcome is added to 'result'.
+    template<typename TEvent>
+    void post(TargetBase* target, typename EventPool<TEvent>::Ref event, std::uint64_t origin, EmitResult& result,
+              bool wait) {
+        bool waited = false;
+        for (;;) {
+            if (closing.load(std::memory_order_acquire)) {
+                return; // Being destroyed: like an expired listener, it gets nothing.
+            }
+            if (target->reserveCredit()) {
+                if (tryPost<TEvent>(target, event, origin)) {
+                    if (waited) {
+                        ++result.blocked;
+                        target->blocked.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    ++result.queued;
+                    return;
+                }
+                target->inFlight.fetch_sub(1); // The ring itself is full.
+            }
+            switch (target->backpressure.overflow) {
+            case Backpressure::Overflow::Shed:
+                ++result.shed;
+                target->shed.fetch_add(1, std::memory_order_relaxed);
+                return;
+            case Backpressure::Overflow::Coalesce: {
+                // Park this event as the newest one, dropping whatever was parked.
+                void* replaced = target->newest.exchange(event.detach());
+                if (replaced != nullptr) {
+                    target->run(nullptr, replaced, 0);
+                }
+                ++result.coalesced;
+                target->coalesced.fetch_add(1, std::memory_order_relaxed);
+                // If the consumer freed a credit meanwhile, it may have missed the
+                // parked event: take it back and queue it normally.
+                if (!target->hasCredit()) {
+                    return;
+                }
+                void* parked = target->newest.exchange(nullptr);
+                if (parked == nullptr) {
+                    return; // The consumer picked it up.
+                }
+                event = EventPool<TEvent>::Ref::attach(parked);
+                --result.coalesced; // Not coalesced after all: undo both counts.
+                target->coalesced.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+            case Backpressure::Overflow::Block:
+                if (!wait) {
+                    ++result.rejected;
+                    return;
+                }
+                if (consumer.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+                    throw std::logic_error(std::string("Block subscription emitted into from its own consumer: ") +
+                                           target->eventName);
+                }
+                waited = true;
+                std::this_thread::yield();
+                break;
+            }
+        }
+    }
+
+    // complete(target): the consumer finished one queued delivery for 'target'.
+    // Frees its credit and, for Coalesce subscriptions, runs the parked newest event.
+    void complete(TargetBase* target) {
+        target->inFlight.fetch_sub(1);
+        target->delivered.store(target->delivered.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (target->newest.load() != nullptr) {
+            if (void* parked = target->newest.exchange(nullptr)) {
+                target->run(target, parked, 0); // Coalesced events are not traced.
+                target->delivered.store(target->delivered.load(std::memory_order_relaxed) + 1,
+                                        std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    // Mailbox(capacity): 'capacity' is rounded up to a power of two.
+    explicit Mailbox(std::size_t capacity = 4096) : mask(roundUp(capacity) - 1) {
+        ring.reset(new Entry[mask + 1]);
+        for (std::size_t i = 0; i <= mask; ++i) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    ~Mailbox() {
+        // Stop new posts, release any poster waiting for credit (only drain() could
+        // give it one, and nobody will call it again), then wait for emits already
+        // posting here to finish.
+        std::weak_ptr<char> posters = alive;
+        alive.reset();
+        closing.store(true, std::memory_order_release);
+        while (!posters.expired()) {
+            std::this_thread::yield();
+        }
+        // Release the events of deliveries that were never drained.
+        std::size_t position = head.load(std::memory_order_relaxed);
+        for (;; ++position) {
+            Entry& entry = ring[position & mask];
+            if (entry.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            entry.run(nullptr, entry.event, 0);
+        }
+        for (auto& target : targets) {
+            if (void* parked = target->newest.exchange(nullptr)) {
+                target->run(nullptr, parked, 0);
+            }
+        }
+    }
+
+    // drain(maxBatch): called by the owning thread. Runs up to 'maxBatch' queued
+    // deliveries and returns how many ran.
+    std::size_t drain(std::size_t maxBatch = static_cast<std::size_t>(-1)) {
+        struct ConsumerGuard {
+            std::atomic<std::thread::id>& consumer;
+            explicit ConsumerGuard(std::atomic<std::thread::id>& consumer) : consumer(consumer) {
+                consumer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            }
+            ~ConsumerGuard() { consumer.store(std::thread::id(), std::memory_order_relaxed); }
+        } guard(consumer);
+        std::size_t ran = 0;
+        std::size_t position = head.load(std::memory_order_relaxed);
+        while (ran < maxBatch) {
+            Entry& entry = ring[position & mask];
+            if (entry.sequence.load(std::memory_order_acquire) != position + 1) {
+                break; // Empty (or the next producer has not finished writing).
+            }
+            auto run = entry.run;
+            TargetBase* target = entry.target;
+            void* event = entry.event;
+            std::uint64_t origin = entry.origin;
+            // Free the cell before running the handler so producers can reuse it.
+            entry.sequence.store(position + mask + 1, std::memory_order_release);
+            ++position;
+            head.store(position, std::memory_order_relaxed);
+            run(target, event, origin);
+            complete(target);
+            ++ran;
+        }
+        return ran;
+    }
+
+    // SubscriptionStats: a snapshot of one subscription's queue and overflow counters.
+    struct SubscriptionStats {
+        const char* eventName;
+        std::uint32_t credits;
+        std::uint32_t depth;     // Deliveries queued or running right now.
+        std::uint32_t peakDepth;
+        std::uint64_t delivered;
+        std::uint64_t shed;
+        std::uint64_t coalesced;
+        std::uint64_t blocked;
+    };
+
+    // stats(): per-subscription instrumentation, in subscription order.
+    std::vector<SubscriptionStats> stats() {
+        std::lock_guard<std::mutex> lock(targetMutex);
+        std::vector<SubscriptionStats> result;
+        for (const auto& target : targets) {
+            result.push_back({target->eventName, target->backpressure.credits,
+                              target->inFlight.load(std::memory_order_relaxed),
+                              target->peakDepth.load(std::memory_order_relaxed),
+                              target->delivered.load(std::memory_order_relaxed),
+                              target->shed.load(std::memory_order_relaxed),
+                              target->coalesced.load(std::memory_order_relaxed),
+                              target->blocked.load(std::memory_order_relaxed)});
+        }
+        return result;
+    }
+
+    // pending(): approximate number of queued deliveries.
+    std::size_t pending() const {
+        return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+    }
+
+private:
+    static std::size_t roundUp(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+};
+
+// PendingQuery: an asynchronous query waiting for its responder (see
+// EventBus::queryAsync). The node lives inside the caller's QueryFuture and is
+// threaded into the bus's queue through 'prev'/'next', so queuing never allocates.
+struct PendingQuery {
+    enum class State : std::uint8_t { Queued, Running, Ready };
+
+    PendingQuery* prev = nullptr;
+    PendingQuery* next = nullptr;
+    std::atomic<State> state{State::Queued};
+
+    virtual void answer() = 0; // Runs the responder and stores the response.
+
+protected:
+    ~PendingQuery() = default;
+};
+
+template<typename TReq, typename TResp>
+class QueryFuture;
 
 // EventBus class: Manages the subscription and emission of various event types.
 // It acts as a central dispatcher for events in your application.
 class EventBus {
 private:
-    // A map where:
-    // - The key (void*) uniquely identifies an event type (e.g., PlayerMovedEvent, EnemySpawnedEvent).
-    //   We use a 'void*' obtained from a static function to get a unique address per type.
-    // - The value (std::vector<std::function<void(const void*)>>) is a list of
-    //   type-erased listener functions. Each function takes a 'const void*'
+    // Listener: one subscription.
+    // - 'call' is the type-erased listener function. It takes a 'const void*'
     //   which will actually point to the event object being emitted.
-    std::map<void*, std::vector<std::function<void(const void*)>>> listeners;
+    // - 'owner' is set for lifetime-bound subscriptions. Once the owner has been
+    //   destroyed the listener is dead: it is never called again and is removed
+    //   from the list the next time the list is walked.
+    struct Listener {
+        std::function<void(const void*)> call;
+        std::weak_ptr<void> owner;
+        bool bound = false; // True if 'owner' decides this listener's lifetime.
+
+        // Set for subscriptions bound to a Mailbox: emit enqueues the event there
+        // instead of calling 'call', and the mailbox's thread runs the handler.
+        Mailbox* mailbox = nullptr;
+        Mailbox::TargetBase* mailboxTarget = nullptr;
+
+        // Delivery policy state: a few counters updated inside emit.
+        DeliveryPolicy policy;
+        std::uint64_t seen = 0;          // Events considered (EveryNth) or seen in this window.
+        std::uint64_t windowStart = 0;   // Start of the current one-second window (ns).
+        std::uint64_t random = 0x9E3779B97F4A7C15ull; // xorshift state for Reservoir.
+
+        bool expired() const { return bound && owner.expired(); }
+
+        // admit(now): true if this event should be delivered. 'now' is read from the
+        // clock at most once per emit, and only if some listener needs it.
+        bool admit(std::uint64_t& now) {
+            switch (policy.kind) {
+            case DeliveryPolicy::Kind::Every:
+                return true;
+            case DeliveryPolicy::Kind::EveryNth:
+                return seen++ % policy.n == 0;
+            case DeliveryPolicy::Kind::MaxPerSecond:
+                checkWindow(now);
+                return seen++ < policy.n;
+            case DeliveryPolicy::Kind::Reservoir: {
+                checkWindow(now);
+                std::uint64_t index = ++seen;
+                if (index <= policy.n) {
+                    return true;
+                }
+                random ^= random << 13;
+                random ^= random >> 7;
+                random ^= random << 17;
+                return random % index < policy.n;
+            }
+            }
+            return true;
+        }
+
+        // windowClock(): nanoseconds for one-second windows. Millisecond accuracy is
+        // plenty, so Linux uses the coarse clock, which costs a few ns instead of ~20.
+        static std::uint64_t windowClock() {
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+            timespec time;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+            return static_cast<std::uint64_t>(time.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(time.tv_nsec);
+#else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        // checkWindow(now): starts a new window once a second has passed. The clock is
+        // only consulted when the first window opens and once the current window's
+        // quota of n events is used up: until then nothing would be dropped anyway,
+        // so a listener under its cap costs just a counter, and one over its cap
+        // notices the new second on the very next event, however slow the rate.
+        void checkWindow(std::uint64_t& now) {
+            if (seen < policy.n && windowStart != 0) {
+                return;
+            }
+            if (now == 0) {
+                now = windowClock();
+            }
+            if (windowStart == 0 || now - windowStart >= 1000000000ull) {
+                windowStart = now;
+                seen = 0;
+            }
+        }
+    };
+
+    // A map where:
+    // - The key (void*) uniquely identifies an event type (e.g., PlayerMovedEvent, EnemySpawnedEvent).
+    //   We use a 'void*' obtained from a static function to get a unique address per type.
+    // - The value (std::vector<Listener>) is the contiguous list of listeners for that type.
+    std::map<void*, std::vector<Listener>> listeners;
+
+    // How many emits are running right now (a handler may emit again). Lists are
+    // only compacted when this is 0, so no walk ever sees a listener move or a
+    // list shrink underneath it.
+    int emitDepth = 0;
+
+    // When true (the default), subscribe/emit narrate what they do on std::cout.
+    // Benchmarks turn this off so they measure dispatch rather than console I/O.
+    bool logging = true;
+
+    // Scheduled emits (emitAt/emitAfter/emitEvery) live in a timing wheel with one
+    // tick per millisecond, counted from the moment the bus was created. The mutex
+    // is recursive because a scheduled emit may itself schedule or cancel timers.
+    std::recursive_mutex timerMutex;
+    TimingWheel timerWheel;
+    const std::chrono::steady_clock::time_point timerEpoch = std::chrono::steady_clock::now();
+
+    // Request/response queries: at most one responder per request type, answering
+    // with the one response type it was registered for. Each request type gets a
+    // small number the first time it is used (queryTypeId), which indexes this
+    // bus's slot table directly: no map lookup and no std::function.
+    // A slot holds a Responder<TReq, TResp>, a plain function pointer plus the
+    // handler it calls, with the handler's real signature, so a query passes the
+    // request by reference and returns the response by value with one direct call.
+    //
+    // Slots are published with a release store and never replaced or freed while
+    // the bus lives, so queries from any thread need no lock; respond() takes
+    // responderMutex only to keep two registrations for the same request apart.
+    struct ResponderBase {
+        void* responseKey; // getTypeKey<TResp>(), checked by every query.
+        explicit ResponderBase(void* responseKey) : responseKey(responseKey) {}
+        virtual ~ResponderBase() = default;
+    };
+
+    template<typename TReq, typename TResp>
+    struct Responder : ResponderBase {
+        Responder() : ResponderBase(getTypeKey<TResp>()) {}
+        TResp (*invoke)(const Responder& self, const TReq& request) = nullptr;
+        TResp call(const TReq& request) const { return invoke(*this, request); }
+    };
+
+    // HandlerResponder: owns the handler; invoke calls it with no type erasure.
+    template<typename TReq, typename TResp, typename THandler>
+    struct HandlerResponder final : Responder<TReq, TResp> {
+        THandler handler;
+        explicit HandlerResponder(THandler handler) : handler(std::move(handler)) {
+            this->invoke = [](const Responder<TReq, TResp>& self, const TReq& request) -> TResp {
+                return static_cast<const HandlerResponder&>(self).handler(request);
+            };
+        }
+    };
+
+    static constexpr std::size_t MaxQueryTypes = 256;
+    std::atomic<ResponderBase*> responders[MaxQueryTypes] = {};
+    std::mutex responderMutex;
+
+    static std::atomic<std::size_t>& queryTypeCounter() {
+        static std::atomic<std::size_t> counter{0};
+        return counter;
+    }
+
+    template<typename TReq>
+    static std::size_t queryTypeId() {
+        static const std::size_t id = queryTypeCounter().fetch_add(1, std::memory_order_relaxed);
+        if (id >= MaxQueryTypes) {
+            throw std::length_error("Too many query types (raise EventBus::MaxQueryTypes)");
+        }
+        return id;
+    }
+
+    // Asynchronous queries waiting for processQueries(), oldest first.
+    std::mutex queryMutex;
+    PendingQuery* queryHead = nullptr;
+    PendingQuery* queryTail = nullptr;
+
+    template<typename TReq, typename TResp>
+    friend class QueryFuture;
+
+    template<typename TReq, typename TResp>
+    const Responder<TReq, TResp>& responderFor() const {
+        ResponderBase* responder = responders[queryTypeId<TReq>()].load(std::memory_order_acquire);
+        if (responder == nullptr) {
+            throw std::logic_error(std::string("No responder for query type: ") + typeid(TReq).name());
+        }
+        if (responder->responseKey != getTypeKey<TResp>()) {
+            throw std::logic_error(std::string("Responder for query type ") + typeid(TReq).name() +
+                                   " does not answer with " + typeid(TResp).name());
+        }
+        return static_cast<const Responder<TReq, TResp>&>(*responder);
+    }
+
+    // unlinkQuery(query): removes a queued query. Caller holds queryMutex.
+    void unlinkQuery(PendingQuery* query) {
+        (query->prev ? query->prev->next : queryHead) = query->next;
+        (query->next ? query->next->prev : queryTail) = query->prev;
+        query->prev = query->next = nullptr;
+    }
+
+    void enqueueQuery(PendingQuery* query) {
+        std::lock_guard<std::mutex> lock(queryMutex);
+        query->prev = queryTail;
+        (queryTail ? queryTail->next : queryHead) = query;
+        queryTail = query;
+    }
+
+    // withdrawQuery(query): called when a QueryFuture is destroyed. A queued query
+    // is simply unlinked; one being answered right now is waited for.
+    void withdrawQuery(PendingQuery* query) {
+        if (query->state.load(std::memory_order_acquire) == PendingQuery::State::Ready) {
+            return; // Already answered: the bus no longer refers to it.
+        }
+        {
+            std::lock_guard<std::mutex> lock(queryMutex);
+            if (query->state.load(std::memory_order_relaxed) == PendingQuery::State::Queued) {
+                unlinkQuery(query);
+                return;
+            }
+        }
+        while (query->state.load(std::memory_order_acquire) != PendingQuery::State::Ready) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Optional bus-owned thread that advances the wheel in real time.
+    std::thread timerThread;
+    std::mutex timerThreadMutex;
+    std::condition_variable timerThreadWake;
+    bool timerThreadStop = false;
+
+    // toTick(when): the first tick at or after 'when'.
+    std::uint64_t toTick(std::chrono::steady_clock::time_point when) const {
+        if (when <= timerEpoch) {
+            return 0;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(when - timerEpoch).count();
+        return static_cast<std::uint64_t>((elapsed + 999999) / 1000000);
+    }
+
+    // getTypeKey<TEvent>()
+    // This template function provides a unique address for each distinct event type TEvent.
+    // It leverages the fact that a static variable's address is unique within the program
+    // and distinct for each specialization of the template.
+    // This address serves as the key in our 'listeners' map to identify event types.
+    template<typename TEvent>
+    static void* getTypeKey() {
+        static char key; // A dummy static variable, its address is unique per TEvent type.
+        return &key;     // Return the address, which acts as our unique type identifier.
+    }
+
+    // wrap<TEvent>(handler)
+    // Wraps the user's 'handler' into a std::function that accepts 'const void*'.
+    // This wrapper performs the necessary type-safe casting internally.
+    // When an event is emitted, its address (as const void*) is passed to this wrapper.
+    // The wrapper then casts it back to the expected 'const TEvent*' and calls the original 'handler'.
+    template<typename TEvent>
+    static std::function<void(const void*)> wrap(std::function<void(const TEvent&)> handler) {
+        return [handler](const void* eventPtr) {
+            // Safely cast the 'const void*' back to 'const TEvent*'.
+            // We know this cast is safe because 'eventPtr' was originally a 'const TEvent*'.
+            handler(*static_cast<const TEvent*>(eventPtr));
+        };
+    }
+
+    template<typename TEvent>
+    void subscribeMailbox(Mailbox& mailbox, std::function<void(const TEvent&)> handler,
+                          std::weak_ptr<void> owner, bool ownerBound, DeliveryPolicy policy,
+                          Backpressure backpressure) {
+        Listener listener;
+        listener.owner = mailbox.alive;
+        listener.bound = true;
+        listener.mailbox = &mailbox;
+        listener.mailboxTarget = mailbox.addTarget<TEvent>(std::move(handler), std::move(owner), ownerBound,
+                                                           backpressure);
+        listener.policy = policy;
+        addListener<TEvent>(std::move(listener));
+    }
+
+    // addListener<TEvent>(listener)
+    // Appends a listener to the list for TEvent. If the list is full, dead listeners
+    // are swept out first, so a list whose type is rarely emitted still cannot grow
+    // without bound. The sweep only runs when the vector would otherwise reallocate,
+    // which keeps its cost amortized O(1) per subscription. Subscribing from inside
+    // a handler is allowed: emit walks the list by index, so a reallocation is safe,
+    // and the sweep waits until no emit is running.
+    template<typename TEvent>
+    void addListener(Listener listener) {
+        std::vector<Listener>& list = listeners[getTypeKey<TEvent>()];
+        if (list.size() == list.capacity() && emitDepth == 0) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [](const Listener& existing) { return existing.expired(); }),
+                       list.end());
+        }
+        list.push_back(std::move(listener));
+
+        if (logging) {
+            std::cout << "Subscribed to event type: " << typeid(TEvent).name() << std::endl;
+        }
+    }
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    EventBus() = default;
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+    ~EventBus() {
+        stopTimerThread();
+        for (auto& responder : responders) {
+            delete responder.load(std::memory_order_relaxed);
+        }
+    }
+
+    // setLogging(enabled)
+    // Turns the tutorial's console narration on or off.
+    void setLogging(bool enabled) { logging = enabled; }
+
+    // subscribe<TEvent>(handler)
+    // Allows a component to register a callback function (handler) for a specific event type TEvent.
+    // The 'handler' function will be called whenever an event of type TEvent is emitted.
+    // An optional DeliveryPolicy throttles how many events reach the handler.
+    template<typename TEvent>
+    void subscribe(std::function<void(const TEvent&)> handler, DeliveryPolicy policy = {}) {
+        Listener listener;
+        listener.call = wrap<TEvent>(std::move(handler));
+        listener.policy = policy;
+        addListener<TEvent>(std::move(listener));
+    }
+
+    // subscribe<TEvent>(owner, handler)
+    // Binds the subscription to 'owner': once the last shared_ptr to the owner is
+    // gone, the handler is never called again. Use this when the handler captures
+    // a pointer to the owner, e.g. bus.subscribe<PlayerMovedEvent>(hud, [raw = hud.get()](...) {...}).
+    template<typename TEvent, typename TOwner>
+    void subscribe(const std::shared_ptr<TOwner>& owner, std::function<void(const TEvent&)> handler,
+                   DeliveryPolicy policy = {}) {
+        Listener listener;
+        listener.call = wrap<TEvent>(std::move(handler));
+        listener.owner = owner;
+        listener.bound = true;
+        listener.policy = policy;
+        addListener<TEvent>(std::move(listener));
+    }
+
+    // subscribe<TEvent>(mailbox, handler) / subscribe<TEvent>(mailbox, owner, handler)
+    // Delivers TEvent on the mailbox owner's thread: emit only enqueues the event,
+    // and the handler runs when that thread calls mailbox.drain(). The subscription
+    // ends when the mailbox is destroyed (or, if given, when 'owner' is).
+    // 'backpressure' bounds how far this subscription may fall behind.
+    template<typename TEvent>
+    void subscribe(Mailbox& mailbox, std::function<void(const TEvent&)> handler, DeliveryPolicy policy = {},
+                   Backpressure backpressure = {}) {
+        subscribeMailbox<TEvent>(mailbox, std::move(handler), {}, false, policy, backpressure);
+    }
+
+    template<typename TEvent, typename TOwner>
+    void subscribe(Mailbox& mailbox, const std::shared_ptr<TOwner>& owner,
+                   std::function<void(const TEvent&)> handler, DeliveryPolicy policy = {},
+                   Backpressure backpressure = {}) {
+        subscribeMailbox<TEvent>(mailbox, std::move(handler), owner, true, policy, backpressure);
+    }
+
+    // subscribeScoped<TEvent>(handler)
+    // Like subscribe, but the caller receives a ListenerToken that owns the
+    // subscription. Dropping the token unsubscribes the handler.
+    template<typename TEvent>
+    ListenerToken subscribeScoped(std::function<void(const TEvent&)> handler, DeliveryPolicy policy = {}) {
+        auto lifetime = std::make_shared<char>();
+        subscribe<TEvent>(lifetime, std::move(handler), policy);
+        return ListenerToken(std::move(lifetime));
+    }
+
+    // listenerCount<TEvent>()
+    // Number of listener slots currently stored for TEvent, including any dead
+    // ones that have not been compacted away yet.
+    template<typename TEvent>
+    std::size_t listenerCount() const {
+        auto it = listeners.find(getTypeKey<TEvent>());
+        return it == listeners.end() ? 0 : it->second.size();
+    }
+
+    // emit<TEvent>(event)
+    // Publishes an event of type TEvent to all registered listeners.
+    // The EventBus iterates through all handlers subscribed to TEvent and invokes them,
+    // passing a constant reference to the 'event' object.
+    // The returned EmitResult tells the producer how each delivery went; check
+    // saturated() to learn that a mailbox listener is falling behind.
+    template<typename TEvent>
+    EmitResult emit(const TEvent& event) {
+        return emitFrom(EventTracer::instance().stamp(), event);
+    }
+
+    // emitFrom<TEvent>(origin, event, wait)
+    // emit() for events that were created earlier and queued (see EventCollector):
+    // 'origin' is the stamp taken when the event was first emitted, so tracing
+    // measures the whole emit-to-handle latency. 0 means "not traced".
+    // 'wait' false is tryEmit: Block subscriptions reject instead of waiting.
+    template<typename TEvent>
+    EmitResult emitFrom(std::uint64_t origin, const TEvent& event, bool wait = true) {
+        EmitResult result;
+        // Get the unique key for this event type.
+        void* key = getTypeKey<TEvent>();
+
+        // Check if there are any listeners registered for this specific event type.
+        auto it = listeners.find(key);
+        if (it != listeners.end()) {
+            if (logging) {
+                std::cout << "Emitting event: " << typeid(TEvent).name() << std::endl;
+            }
+            // Iterate over all handlers registered for TEvent.
+            // Pass the address of the 'event' object as 'const void*' to each handler.
+            //
+            // Dead listeners are skipped, and removed in one pass after the walk
+            // (keeping the order of the live ones). A handler may emit again, so
+            // that pass only runs once the outermost emit is done: until then the
+            // list never shrinks and no listener moves. The walk indexes the vector
+            // instead of holding references, because a handler that subscribes may
+            // make it reallocate; listeners added during the walk first hear the
+            // next event.
+            //
+            // Each listener's DeliveryPolicy is checked before its handler is called;
+            // a throttled listener is skipped for this event but stays subscribed.
+            //
+            // Mailbox listeners share one pooled copy of the event, made on first use.
+            std::vector<Listener>& list = it->second;
+            const std::size_t count = list.size();
+            bool sawDead = false;
+            struct DepthGuard {
+                int& depth;
+                explicit DepthGuard(int& depth) : depth(depth) { ++depth; }
+                ~DepthGuard() { --depth; }
+            };
+            std::uint64_t now = 0; // Read lazily by time-based policies.
+            typename EventPool<TEvent>::Ref pooled;
+            // deliver(i): nothing may touch list[i] after its handler returns.
+            auto deliver = [&](std::size_t i) {
+                Listener& listener = list[i];
+                if (listener.mailbox == nullptr) {
+                    if (origin != 0) {
+                        EventTracer::instance().traced<TEvent>(origin, [&] { list[i].call(&event); });
+                    } else {
+                        listener.call(static_cast<const void*>(&event));
+                    }
+                    ++result.called;
+                    return;
+                }
+                if (!pooled) {
+                    pooled = EventPool<TEvent>::instance().acquire(event);
+                }
+                listener.mailbox->post<TEvent>(listener.mailboxTarget, pooled, origin, result, wait);
+            };
+            {
+                DepthGuard depth(emitDepth);
+                for (std::size_t i = 0; i < count; ++i) {
+                    if (list[i].bound) {
+                        // lock() keeps the owner alive while its handler runs.
+                        std::shared_ptr<void> owner = list[i].owner.lock();
+                        if (!owner) {
+                            sawDead = true;
+                            continue;
+                        }
+                        if (list[i].admit(now)) {
+                            deliver(i);
+                        }
+                    } else if (list[i].admit(now)) {
+                        deliver(i);
+                    }
+                }
+            }
+            if (sawDead && emitDepth == 0) {
+                list.erase(std::remove_if(list.begin(), list.end(),
+                                          [](const Listener& listener) { return listener.expired(); }),
+                           list.end());
+            }
+        } else if (logging) {
+            std::cout << "No listeners for event type: " << typeid(TEvent).name() << std::endl;
+        }
+        return result;
+    }
+
+    // tryEmit<TEvent>(event)
+    // Like emit, but never waits: a Block subscription that is out of credit, or
+    // whose mailbox is full, does not get the event and is counted in 'rejected'.
+    // Every other listener is delivered to as usual, so the producer can retry the
+    // rejected ones later or do something else in the meantime. The decision is
+    // made as each delivery is posted, so no other producer can take the credit
+    // between a check and the post.
+    template<typename TEvent>
+    EmitResult tryEmit(const TEvent& event) {
+        return emitFrom(EventTracer::instance().stamp(), event, false);
+    }
+
+    // emitAt<TEvent>(when, event)
+    // Emits a copy of 'event' once 'when' has been reached, as observed by the next
+    // advanceTimers() call or by the timer thread. Returns a handle for cancelTimer.
+    // The copy lives in EventPool<TEvent>; the timer action holds only a Ref to it,
+    // which is small enough for std::function to store without allocating.
+    template<typename TEvent>
+    TimerId emitAt(Clock::time_point when, const TEvent& event) {
+        std::lock_guard<std::recursive_mutex> lock(timerMutex);
+        return timerWheel.schedule(toTick(when), 0,
+                                   [this, pooled = EventPool<TEvent>::instance().acquire(event)] { emit(*pooled); });
+    }
+
+    // emitAfter<TEvent>(delay, event): emitAt(now + delay, event).
+    template<typename TEvent>
+    TimerId emitAfter(Clock::duration delay, const TEvent& event) {
+        return emitAt(Clock::now() + delay, event);
+    }
+
+    // emitEvery<TEvent>(period, event)
+    // Emits a copy of 'event' every 'period' (rounded to whole milliseconds, at
+    // least one), starting one period from now, until cancelled.
+    template<typename TEvent>
+    TimerId emitEvery(Clock::duration period, const TEvent& event) {
+        std::lock_guard<std::recursive_mutex> lock(timerMutex);
+        auto periodTicks = std::max<std::int64_t>(1, std::chrono::duration_cast<std::chrono::milliseconds>(period).count());
+        return timerWheel.schedule(toTick(Clock::now() + period), static_cast<std::uint64_t>(periodTicks),
+                                   [this, pooled = EventPool<TEvent>::instance().acquire(event)] { emit(*pooled); });
+    }
+
+    // cancelTimer(id): stops a scheduled emit. Returns false if it already happened.
+    bool cancelTimer(TimerId id) {
+        std::lock_guard<std::recursive_mutex> lock(timerMutex);
+        return timerWheel.cancel(id);
+    }
+
+    // pendingTimers(): number of scheduled emits that have not fired yet.
+    std::size_t pendingTimers() {
+        std::lock_guard<std::recursive_mutex> lock(timerMutex);
+        return timerWheel.pending();
+    }
+
+    // advanceTimers(now)
+    // Fires every scheduled emit due at or before 'now'. Call it once per frame from
+    // the main loop so scheduled events are delivered on the main thread.
+    void advanceTimers(Clock::time_point now = Clock::now()) {
+        std::lock_guard<std::recursive_mutex> lock(timerMutex);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - timerEpoch).count();
+        if (elapsed > 0) {
+            timerWheel.advance(static_cast<std::uint64_t>(elapsed));
+        }
+    }
+
+    // startTimerThread() / stopTimerThread()
+    // Alternatively, let the bus advance its timers on its own thread, once per
+    // tick. Scheduled events are then emitted (and their handlers run) on that
+    // thread, so use this only when no other thread emits at the same time.
+    void startTimerThread() {
+        if (timerThread.joinable()) {
+            return;
+        }
+        timerThreadStop = false;
+        timerThread = std::thread([this] {
+            std::unique_lock<std::mutex> lock(timerThreadMutex);
+            while (!timerThreadStop) {
+                lock.unlock();
+                advanceTimers();
+                lock.lock();
+                timerThreadWake.wait_for(lock, std::chrono::milliseconds(1), [this] { return timerThreadStop; });
+            }
+        });
+    }
+
+    void stopTimerThread() {
+        if (!timerThread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(timerThreadMutex);
+            timerThreadStop = true;
+        }
+        timerThreadWake.notify_all();
+        timerThread.join();
+    }
+
+    // respond<TReq, TResp>(handler)
+    // Registers the single responder that answers queries of type TReq with a TResp,
+    // e.g. "which enemies are within range?". Registering a second one for TReq is
+    // an error, whatever its response type.
+    // Any callable taking 'const TReq&' and returning a TResp will do; it is stored
+    // as is and called directly. Safe to call while other threads are querying.
+    template<typename TReq, typename TResp, typename THandler>
+    void respond(THandler handler) {
+        std::atomic<ResponderBase*>& slot = responders[queryTypeId<TReq>()];
+        std::lock_guard<std::mutex> lock(responderMutex);
+        if (slot.load(std::memory_order_relaxed) != nullptr) {
+            throw std::logic_error(std::string("Responder already registered for query type: ") + typeid(TReq).name());
+        }
+        slot.store(new HandlerResponder<TReq, TResp, THandler>(std::move(handler)), std::memory_order_release);
+    }
+
+    // query<TReq, TResp>(request)
+    // Asks the responder directly and returns its answer: one call, no reply event,
+    // no correlation state. Throws std::logic_error if nobody responds to TReq.
+    template<typename TReq, typename TResp>
+    TResp query(const TReq& request) {
+        return responderFor<TReq, TResp>().call(request);
+    }
+
+    // queryAsync<TReq, TResp>(request)
+    // Queues the request (from any thread) to be answered by the next
+    // processQueries() call on the bus's thread. The returned QueryFuture holds the
+    // request, the response and the queue node, so nothing is allocated per call.
+    // Use it as 'auto answer = bus.queryAsync<TReq, TResp>(request);'.
+    template<typename TReq, typename TResp>
+    QueryFuture<TReq, TResp> queryAsync(const TReq& request) {
+        return QueryFuture<TReq, TResp>(*this, responderFor<TReq, TResp>(), request);
+    }
+
+    // processQueries(): answers every queued asynchronous query, oldest first,
+    // and returns how many were answered.
+    std::size_t processQueries() {
+        std::size_t answered = 0;
+        for (;;) {
+            PendingQuery* query;
+            {
+                std::lock_guard<std::mutex> lock(queryMutex);
+                query = queryHead;
+                if (query == nullptr) {
+                    return answered;
+                }
+                unlinkQuery(query);
+                query->state.store(PendingQuery::State::Running, std::memory_order_relaxed);
+            }
+            query->answer();
+            query->state.store(PendingQuery::State::Ready, std::memory_order_release);
+            ++answered;
+        }
+    }
+
+    // unsubscribe: subscriptions are removed through their lifetime instead of by
+    // handle. Destroy the owner passed to subscribe(owner, handler), or drop the
+    // ListenerToken returned by subscribeScoped(handler).
+};
+
+// QueryFuture<TReq, TResp>: the result of EventBus::queryAsync.
+// It cannot be copied or moved because the bus's queue points into it; C++17's
+// guaranteed copy elision still lets queryAsync return it by value.
+template<typename TReq, typename TResp>
+class QueryFuture final : private PendingQuery {
+private:
+    EventBus& bus;
+    const EventBus::Responder<TReq, TResp>& responder;
+    TReq request;
+    std::optional<TResp> response;
+
+    friend class EventBus;
+
+    QueryFuture(EventBus& bus, const EventBus::Responder<TReq, TResp>& responder, const TReq& request)
+        : bus(bus), responder(responder), request(request) {
+        bus.enqueueQuery(this);
+    }
+
+    void answer() override { response.emplace(responder.call(request)); }
+
+public:
+    QueryFuture(const QueryFuture&) = delete;
+    QueryFuture& operator=(const QueryFuture&) = delete;
+    ~QueryFuture() { bus.withdrawQuery(this); }
+
+    // ready(): true once processQueries() has answered this query.
+    bool ready() const { return state.load(std::memory_order_acquire) == State::Ready; }
+
+    // get(): the response, waiting for it if necessary. Another thread must be
+    // calling processQueries(), or this waits forever.
+    const TResp& get() const {
+        while (!ready()) {
+            std::this_thread::yield();
+        }
+        return *response;
+    }
+};
+
+// --- Symbols: Interned Event Payload Names ---
+// Event payloads repeat the same handful of names ("Hero", "Goblin") over and over.
+// Storing them as std::string means an allocation and a copy for every event that
+// carries a long name, and a character-by-character compare in every listener.
+//
+// Interning stores each distinct string exactly once in a global SymbolTable and
+// hands out a small integer ID for it. A Symbol is just that ID: copying it is a
+// 4-byte copy and comparing two Symbols is a single integer compare.
+//
+// Thread safety:
+// - Turning a string into a Symbol (intern) first checks a thread-local cache, so
+//   threads that keep interning the same names never touch shared state. Only the
+//   first sighting of a name on a thread takes the table's mutex.
+// - Turning a Symbol back into a string (name) is lock-free: strings live in
+//   fixed-size chunks that are never moved or freed, and each chunk pointer is
+//   published through an atomic.
+
+class SymbolTable {
+private:
+    static constexpr std::uint32_t ChunkBits = 12;
+    static constexpr std::uint32_t ChunkSize = 1u << ChunkBits; // Strings per chunk.
+    static constexpr std::uint32_t MaxChunks = 1024;            // Up to 4M distinct symbols.
+
+    // ID -> string storage. A chunk, once published, is never reallocated, so
+    // references returned by name() stay valid for the lifetime of the program.
+    std::atomic<std::string*> chunks[MaxChunks] = {};
+
+    std::mutex writeMutex;                               // Guards 'ids' and 'count'.
+    std::unordered_map<std::string, std::uint32_t> ids;  // string -> ID
+    std::uint32_t count = 0;
+
+    SymbolTable() { intern(std::string()); } // ID 0 is always the empty string.
+
+    // threadCache(): this thread's string -> ID lookups, so repeats skip the lock.
+    static std::unordered_map<std::string, std::uint32_t>& threadCache() {
+        thread_local std::unordered_map<std::string, std::uint32_t> cache;
+        return cache;
+    }
+
+    std::uint32_t insert(const std::string& text) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto it = ids.find(text);
+        if (it != ids.end()) {
+            return it->second; // Another thread interned it first.
+        }
+        std::uint32_t id = count;
+        std::uint32_t chunk = id >> ChunkBits;
+        if (chunk >= MaxChunks) {
+            throw std::length_error("SymbolTable is full");
+        }
+        std::string* slots = chunks[chunk].load(std::memory_order_relaxed);
+        if (slots == nullptr) {
+            slots = new std::string[ChunkSize];
+            chunks[chunk].store(slots, std::memory_order_release);
+        }
+        slots[id & (ChunkSize - 1)] = text;
+        ids.emplace(text, id);
+        ++count;
+        return id;
+    }
+
+public:
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // global(): the single process-wide table all Symbols refer to.
+    static SymbolTable& global() {
+        static SymbolTable table;
+        return table;
+    }
+
+    // intern(text): returns the ID for 'text', adding it to the table if needed.
+    std::uint32_t intern(const std::string& text) {
+        auto& cache = threadCache();
+        auto it = cache.find(text);
+        if (it != cache.end()) {
+            return it->second;
+        }
+        std::uint32_t id = insert(text);
+        cache.emplace(text, id);
+        return id;
+    }
+
+    // contains(text): whether 'text' is already interned (so interning it again
+    // would not grow the table).
+    bool contains(const std::string& text) {
+        if (threadCache().count(text) != 0) {
+            return true; // Interned on this thread before: no lock needed.
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        return ids.count(text) != 0;
+    }
+
+    // name(id): the string an ID stands for. Lock-free.
+    const std::string& name(std::uint32_t id) const {
+        const std::string* slots = chunks[id >> ChunkBits].load(std::memory_order_acquire);
+        return slots[id & (ChunkSize - 1)];
+    }
+};
+
+// Symbol: a 4-byte handle to an interned string.
+// It converts implicitly from string literals, so events can still be written as
+// PlayerMovedEvent{10, 20, "Hero"}.
+class Symbol {
+private:
+    std::uint32_t symbolId = 0; // 0 is the empty string.
+
+public:
+    Symbol() = default;
+    Symbol(const char* text) : symbolId(SymbolTable::global().intern(text)) {}
+    Symbol(const std::string& text) : symbolId(SymbolTable::global().intern(text)) {}
+
+    std::uint32_t id() const { return symbolId; }
+    const std::string& str() const { return SymbolTable::global().name(symbolId); }
+
+    // O(1) equality: two Symbols are equal exactly when their IDs are.
+    friend bool operator==(Symbol a, Symbol b) { return a.symbolId == b.symbolId; }
+    friend bool operator!=(Symbol a, Symbol b) { return a.symbolId != b.symbolId; }
+
+    friend std::ostream& operator<<(std::ostream& out, Symbol symbol) { return out << symbol.str(); }
+};
+
+// Lets Symbols be used as keys in unordered containers.
+namespace std {
+template<>
+struct hash<Symbol> {
+    std::size_t operator()(Symbol symbol) const noexcept { return symbol.id(); }
+};
+}
+
+// --- Example Event Structures ---
+// Define simple struct to represent different types of events.
+// Events are plain data structures that carry information.
+
+// Names that repeat across many events are Symbols rather than std::strings.
+
+struct PlayerMovedEvent {
+    int x, y;
+    Symbol playerName;
+};
+
+struct EnemySpawnedEvent {
+    int enemyID;
+    float health;
+    Symbol type;
+};
+
+struct GameStateChangedEvent {
+    std::string newState;
+};
+
+// Queries pair a request with the response its responder returns.
+
+struct EnemiesInRangeQuery {
+    int x, y;
+    int radius;
+};
+
+struct EnemiesInRangeResult {
+    int count;
+    int nearestEnemyID; // -1 if there is none.
+};
+
+// --- Event Serialization ---
+// Recording events, or sending them to another process, needs a byte encoding for
+// each event type. Rather than hand-writing an encoder and a decoder per struct,
+// an event type lists its fields once:
+//
+//     EVENT_FIELDS(PlayerMovedEvent, x, y, playerName)
+//
+// and EventCodec<PlayerMovedEvent> generates both directions at compile time.
+// The macro binds the event with a structured binding, so the list must have one
+// name per field; a missing or extra field is a compile error. The binding is
+// positional, though: the names are only labels and are not checked against the
+// struct, so a list in the wrong order still compiles (and encodes by position).
+//
+// Wire format: fields in declaration order, packed, in host byte order.
+// - Arithmetic and enum fields are their raw bytes (one memcpy each).
+// - std::string and Symbol fields are a 32-bit length followed by the characters.
+//   Symbol IDs are only meaningful inside one process, so Symbols travel as text
+//   and are re-interned by the decoder.
+// - std::vector fields are a 32-bit count followed by the elements.
+// - Fields whose type has its own EVENT_FIELDS are encoded in place.
+// When every field is raw and the struct has no padding, its memory already *is*
+// the encoding, and the whole event is copied with a single memcpy.
+
+// ByteReader: a bounds-checked cursor over encoded bytes. Every read either
+// succeeds completely or returns false and leaves the output untouched.
+class ByteReader {
+private:
+    const char* cursor;
+    const char* end;
+    std::size_t* symbolAllowance = nullptr; // See limitSymbols.
+    bool symbolRefused = false;
+
+public:
+    ByteReader(const char* data, std::size_t size) : cursor(data), end(data + size) {}
+
+    // limitSymbols(allowance): for input from untrusted peers. Symbols read from
+    // here may add at most '*allowance' new strings to the process-wide
+    // SymbolTable (which is never freed), counting it down; past that, reading a
+    // new one fails and refusedSymbol() becomes true.
+    void limitSymbols(std::size_t* allowance) { symbolAllowance = allowance; }
+    std::size_t* symbolLimit() const { return symbolAllowance; }
+    void refuseSymbol() { symbolRefused = true; }
+    bool refusedSymbol() const { return symbolRefused; }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end - cursor); }
+    const char* position() const { return cursor; }
+
+    bool read(void* out, std::size_t size) {
+        if (remaining() < size) {
+            return false;
+        }
+        std::memcpy(out, cursor, size);
+        cursor += size;
+        return true;
+    }
+
+    // view(size): the next 'size' bytes, without copying them (nullptr if short).
+    const char* view(std::size_t size) {
+        if (remaining() < size) {
+            return nullptr;
+        }
+        const char* start = cursor;
+        cursor += size;
+        return start;
+    }
+};
+
+// EventFields<TEvent>: opt-in field list, provided by EVENT_FIELDS. Like
+// EventColumns, the primary template is left undefined.
+template<typename TEvent>
+struct EventFields;
+
+#define EVENT_FIELDS(Type, ...)                                        \
+    template<>                                                         \
+    struct EventFields<Type> {                                         \
+        static constexpr const char* name = #Type;                     \
+        template<typename E>                                           \
+        static auto tie(E& event) {                                    \
+            auto& [__VA_ARGS__] = event;                               \
+            return std::tie(__VA_ARGS__);                              \
+        }                                                              \
+    }
+
+template<typename T, typename = void>
+struct IsReflected : std::false_type {};
+template<typename T>
+struct IsReflected<T, std::void_t<decltype(EventFields<T>::name)>> : std::true_type {};
+
+// FieldCodec<T>: how one field type is encoded. 'raw' fields are their own bytes.
+template<typename T, typename = void>
+struct FieldCodec;
+
+template<typename T>
+struct FieldCodec<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>> {
+    static constexpr bool raw = true;
+    static std::size_t size(const T&) { return sizeof(T); }
+    static char* write(char* out, const T& value) {
+        std::memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    }
+    static bool read(ByteReader& in, T& value) { return in.read(&value, sizeof(T)); }
+};
+
+// Shared by std::string and Symbol: a 32-bit length, then the characters.
+struct TextCodec {
+    static std::size_t size(const std::string& text) { return sizeof(std::uint32_t) + text.size(); }
+    static char* write(char* out, const std::string& text) {
+        const auto length = static_cast<std::uint32_t>(text.size());
+        std::memcpy(out, &length, sizeof length);
+        std::memcpy(out + sizeof length, text.data(), length);
+        return out + sizeof length + length;
+    }
+    static bool read(ByteReader& in, std::string& text) {
+        std::uint32_t length;
+        ByteReader probe = in;
+        if (!probe.read(&length, sizeof length)) {
+            return false;
+        }
+        const char* characters = probe.view(length);
+        if (characters == nullptr) {
+            return false;
+        }
+        text.assign(characters, length);
+        in = probe;
+        return true;
+    }
+};
+
+template<>
+struct FieldCodec<std::string> : TextCodec {
+    static constexpr bool raw = false;
+};
+
+template<>
+struct FieldCodec<Symbol> {
+    static constexpr bool raw = false;
+    static std::size_t size(Symbol symbol) { return TextCodec::size(symbol.str()); }
+    static char* write(char* out, Symbol symbol) { return TextCodec::write(out, symbol.str()); }
+    static bool read(ByteReader& in, Symbol& symbol) {
+        thread_local std::string text; // Reused, so decoding does not allocate per field.
+        if (!TextCodec::read(in, text)) {
+            return false;
+        }
+        if (std::size_t* allowance = in.symbolLimit()) {
+            if (!SymbolTable::global().contains(text)) {
+                if (*allowance == 0) {
+                    in.refuseSymbol();
+                    return false;
+                }
+                --*allowance;
+            }
+        }
+        symbol = Symbol(text);
+        return true;
+    }
+};
+
+template<typename TEvent>
+class EventCodec;
+
+template<typename T>
+struct FieldCodec<T, std::enable_if_t<IsReflected<T>::value>> {
+    static constexpr bool raw = EventCodec<T>::raw;
+    static std::size_t size(const T& value) { return EventCodec<T>::size(value); }
+    static char* write(char* out, const T& value) { return EventCodec<T>::write(out, value); }
+    static bool read(ByteReader& in, T& value) { return EventCodec<T>::read(in, value); }
+};
+
+// std::vector fields: a 32-bit element count, then the elements. Vectors of
+// memcpy-able elements are copied in one block.
+template<typename T>
+struct FieldCodec<std::vector<T>> {
+    static constexpr bool raw = false;
+
+    static constexpr bool block() {
+        if constexpr (IsReflected<T>::value) {
+            return EventCodec<T>::memcpyable;
+        } else {
+            return std::is_arithmetic_v<T> || std::is_enum_v<T>;
+        }
+    }
+
+    static std::size_t size(const std::vector<T>& values) {
+        std::size_t bytes = sizeof(std::uint32_t);
+        if constexpr (block()) {
+            bytes += values.size() * sizeof(T);
+        } else {
+            for (const T& value : values) {
+                bytes += FieldCodec<T>::size(value);
+            }
+        }
+        return bytes;
+    }
+
+    static char* write(char* out, const std::vector<T>& values) {
+        const auto count = static_cast<std::uint32_t>(values.size());
+        std::memcpy(out, &count, sizeof count);
+        out += sizeof count;
+        if constexpr (block()) {
+            if (count != 0) {
+                std::memcpy(out, values.data(), count * sizeof(T));
+            }
+            return out + count * sizeof(T);
+        } else {
+            for (const T& value : values) {
+                out = FieldCodec<T>::write(out, value);
+            }
+            return out;
+        }
+    }
+
+    static bool read(ByteReader& in, std::vector<T>& values) {
+        std::uint32_t count;
+        if (!in.read(&count, sizeof count) || count > in.remaining()) {
+            return false; // Every element takes at least one byte.
+        }
+        values.resize(count);
+        if constexpr (block()) {
+            return count == 0 || in.read(values.data(), count * sizeof(T));
+        } else {
+            for (T& value : values) {
+                if (!FieldCodec<T>::read(in, value)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+};
+
+// typeTag(name): FNV-1a hash of a type's EVENT_FIELDS name, used to identify
+// event types in recorded or transmitted streams.
+constexpr std::uint32_t typeTag(const char* name) {
+    std::uint32_t hash = 2166136261u;
+    for (; *name != '\0'; ++name) {
+        hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+    }
+    return hash;
+}
+
+// EventCodec<TEvent>: the encoder/decoder generated from EventFields<TEvent>.
+template<typename TEvent>
+class EventCodec {
+private:
+    using Fields = EventFields<TEvent>;
+    using Tied = decltype(Fields::tie(std::declval<TEvent&>()));
+    static constexpr std::size_t FieldCount = std::tuple_size_v<Tied>;
+
+    template<std::size_t I>
+    using FieldType = std::remove_cv_t<std::remove_reference_t<std::tuple_element_t<I, Tied>>>;
+
+    template<std::size_t... I>
+    static constexpr bool allRaw(std::index_sequence<I...>) { return (FieldCodec<FieldType<I>>::raw && ...); }
+    // encodedBytes<T>(): the fixed encoding size of a raw field. A nested reflected
+    // struct contributes its own field sizes, not sizeof, which counts its padding.
+    template<typename T>
+    static constexpr std::size_t encodedBytes() {
+        if constexpr (IsReflected<T>::value) {
+            return EventCodec<T>::rawBytes;
+        } else {
+            return sizeof(T);
+        }
+    }
+    template<std::size_t... I>
+    static constexpr std::size_t fieldBytes(std::index_sequence<I...>) {
+        return (encodedBytes<FieldType<I>>() + ... + 0);
+    }
+
+    using Indices = std::make_index_sequence<FieldCount>;
+
+public:
+    static constexpr const char* name = Fields::name;
+    static constexpr std::uint32_t tag = typeTag(Fields::name);
+
+    // raw: every field is raw, so the encoded size is fixed (rawBytes).
+    static constexpr bool raw = allRaw(Indices{});
+    static constexpr std::size_t rawBytes = raw ? fieldBytes(Indices{}) : 0;
+    // memcpyable: ...and the struct has no padding, so it can be copied whole.
+    static constexpr bool memcpyable = raw && std::is_trivially_copyable_v<TEvent> &&
+                                       std::is_standard_layout_v<TEvent> && rawBytes == sizeof(TEvent);
+
+    // size(event): bytes write() will produce.
+    static std::size_t size(const TEvent& event) {
+        if constexpr (raw) {
+            (void)event;
+            return rawBytes;
+        } else {
+            return std::apply([](const auto&... field) {
+                return (FieldCodec<std::decay_t<decltype(field)>>::size(field) + ... + 0);
+            }, Fields::tie(event));
+        }
+    }
+
+    // write(out, event): encodes 'event' at 'out' (which must have size(event)
+    // bytes available) and returns the end of the encoding.
+    static char* write(char* out, const TEvent& event) {
+        if constexpr (memcpyable) {
+            std::memcpy(out, &event, sizeof(TEvent));
+            return out + sizeof(TEvent);
+        } else {
+            std::apply([&out](const auto&... field) {
+                ((out = FieldCodec<std::decay_t<decltype(field)>>::write(out, field)), ...);
+            }, Fields::tie(event));
+            return out;
+        }
+    }
+
+    // read(in, event): decodes one event; false if the input is truncated, in which
+    // case 'event' may be partly overwritten.
+    static bool read(ByteReader& in, TEvent& event) {
+        if constexpr (memcpyable) {
+            return in.read(&event, sizeof(TEvent));
+        } else {
+            return std::apply([&in](auto&... field) {
+                return (FieldCodec<std::decay_t<decltype(field)>>::read(in, field) && ...);
+            }, Fields::tie(event));
+        }
+    }
+};
+
+// serialize(buffer, event): appends the encoding of 'event' to 'buffer'.
+template<typename TEvent>
+void serialize(std::vector<char>& buffer, const TEvent& event) {
+    const std::size_t at = buffer.size();
+    buffer.resize(at + EventCodec<TEvent>::size(event));
+    EventCodec<TEvent>::write(buffer.data() + at, event);
+}
+
+// serialize(buffer, events, count): appends a batch, growing the buffer once.
+template<typename TEvent>
+void serialize(std::vector<char>& buffer, const TEvent* events, std::size_t count) {
+    using Codec = EventCodec<TEvent>;
+    std::size_t bytes = 0;
+    if constexpr (Codec::raw) {
+        bytes = count * (count ? Codec::size(events[0]) : 0);
+    } else {
+        for (std::size_t i = 0; i < count; ++i) {
+            bytes += Codec::size(events[i]);
+        }
+    }
+    const std::size_t at = buffer.size();
+    buffer.resize(at + bytes);
+    if constexpr (Codec::memcpyable) {
+        std::memcpy(buffer.data() + at, events, bytes); // The whole batch in one copy.
+    } else {
+        char* out = buffer.data() + at;
+        for (std::size_t i = 0; i < count; ++i) {
+            out = Codec::write(out, events[i]);
+        }
+    }
+}
+
+// deserialize(in, event): decodes the next event from 'in'.
+template<typename TEvent>
+bool deserialize(ByteReader& in, TEvent& event) {
+    return EventCodec<TEvent>::read(in, event);
+}
+
+// deserialize(in, events, count): decodes a batch written by serialize(); returns
+// how many events were decoded before the input ran out.
+template<typename TEvent>
+std::size_t deserialize(ByteReader& in, TEvent* events, std::size_t count) {
+    using Codec = EventCodec<TEvent>;
+    if constexpr (Codec::memcpyable) {
+        count = std::min(count, in.remaining() / sizeof(TEvent));
+        in.read(events, count * sizeof(TEvent));
+        return count;
+    } else {
+        std::size_t decoded = 0;
+        while (decoded < count && Codec::read(in, events[decoded])) {
+            ++decoded;
+        }
+        return decoded;
+    }
+}
+
+EVENT_FIELDS(PlayerMovedEvent, x, y, playerName);
+EVENT_FIELDS(EnemySpawnedEvent, enemyID, health, type);
+EVENT_FIELDS(GameStateChangedEvent, newState);
+EVENT_FIELDS(EnemiesInRangeQuery, x, y, radius);
+EVENT_FIELDS(EnemiesInRangeResult, count, nearestEnemyID);
+
+// Listener-owned state can be reflected the same way, e.g. to snapshot it (see
+// EventJournal).
+struct EnemyRoster {
+    std::vector<int> enemyIDs;
+    std::vector<Symbol> types;
+};
+EVENT_FIELDS(EnemyRoster, enemyIDs, types);
+
+// --- Columnar (Structure-of-Arrays) Event Channels ---
+// The EventBus above hands listeners one event struct at a time. That is perfect for
+// gameplay reactions, but analytics listeners that sum or bucket thousands of positions
+// pay a full std::function call per event and walk memory with a large stride
+// (x, y and a std::string are interleaved in every PlayerMovedEvent).
+//
+// A columnar channel stores a *batch* of events as separate contiguous arrays
+// (x[], y[], ...) and hands listeners a view of those columns. Loops over plain
+// `const int*` arrays are exactly what compilers auto-vectorize: build with
+// `-O3 -mavx2` and the sums below turn into 8-wide AVX2 adds.
+//
+// The channel is opt-in per event type: a type takes part by specializing
+// EventColumns<TEvent>, which describes how to split one event into its columns.
+// Symbol fields become columns of their integer IDs.
+
+// EventColumns<TEvent>
+// Primary template is left undefined: only event types that explicitly opt in
+// (by providing a specialization) can be used with a ColumnarChannel.
+template<typename TEvent>
+struct EventColumns;
+
+// Column layout for PlayerMovedEvent: one array per field.
+template<>
+struct EventColumns<PlayerMovedEvent> {
+    // View: what a columnar listener receives. Plain pointers + a count, so the
+    // listener's loops see simple arrays the optimizer can vectorize.
+    struct View {
+        const int* x;
+        const int* y;
+        const std::uint32_t* playerName; // Symbol IDs
+        std::size_t size;
+    };
+
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<std::uint32_t> playerName;
+
+    void reserve(std::size_t n) {
+        x.reserve(n);
+        y.reserve(n);
+        playerName.reserve(n);
+    }
+
+    void append(const PlayerMovedEvent& event) {
+        x.push_back(event.x);
+        y.push_back(event.y);
+        playerName.push_back(event.playerName.id());
+    }
+
+    std::size_t size() const { return x.size(); }
+
+    // clear() keeps the capacity, so a channel in steady state never reallocates.
+    void clear() {
+        x.clear();
+        y.clear();
+        playerName.clear();
+    }
+
+    View view() const { return View{x.data(), y.data(), playerName.data(), x.size()}; }
+};
+
+// ColumnarChannel<TEvent>
+// Buffers events into columns and delivers whole batches to column listeners.
+// A batch is delivered when it reaches 'batchSize' events or when flush() is called.
+template<typename TEvent>
+class ColumnarChannel {
+public:
+    using Columns = EventColumns<TEvent>;
+    using View = typename Columns::View;
+
+private:
+    Columns columns;
+    std::vector<std::function<void(const View&)>> listeners;
+    std::size_t batchSize;
+
+public:
+    explicit ColumnarChannel(std::size_t batchSize = 4096) : batchSize(batchSize) {
+        columns.reserve(batchSize);
+    }
+
+    // subscribe(handler): the handler is called once per batch, not once per event.
+    void subscribe(std::function<void(const View&)> handler) {
+        listeners.push_back(std::move(handler));
+    }
+
+    // emit(event): appends the event to the current batch.
+    void emit(const TEvent& event) {
+        columns.append(event);
+        if (columns.size() >= batchSize) {
+            flush();
+        }
+    }
+
+    // flush(): delivers any buffered events, then starts a new (empty) batch.
+    void flush() {
+        if (columns.size() == 0) {
+            return;
+        }
+        const View batch = columns.view();
+        for (auto& handler : listeners) {
+            handler(batch);
+        }
+        columns.clear();
+    }
+};
+
+// sumPositions(view, sumX, sumY)
+// A typical analytics listener body: no branches, no strings, just two running
+// sums over contiguous arrays, which GCC and Clang vectorize at -O3.
+inline void sumPositions(const EventColumns<PlayerMovedEvent>::View& batch,
+                         std::int64_t& sumX, std::int64_t& sumY) {
+    std::int64_t sx = 0;
+    std::int64_t sy = 0;
+    for (std::size_t i = 0; i < batch.size; ++i) {
+        sx += batch.x[i];
+        sy += batch.y[i];
+    }
+    sumX += sx;
+    sumY += sy;
+}
+
+// --- Per-Thread Event Collection ---
+// EventBus::emit is meant to be called from one thread. When many threads produce
+// events, funnelling them through one mutex-protected queue makes every producer
+// fight over the same lock and cache line.
+//
+// EventCollector gives each producer thread its own append-only buffer instead.
+// A buffer has exactly one writer (its thread) and one reader (whoever calls
+// flush), so appending needs no lock and no read-modify-write on shared data:
+// the producer fills a record, then publishes it with a single release store.
+//
+// Every record is stamped with the steady clock when it is collected. flush()
+// performs a k-way merge over the per-thread buffers, always dispatching the
+// oldest stamped record next, so listeners observe events in the order they were
+// produced. Records stamped after flush() started are left for the next flush.
+class EventCollector {
+private:
+    // Record: one collected event. Small events are stored inline; larger ones are
+    // copied into EventPool<TEvent> and the record holds a Ref to the pooled copy.
+    // 'dispatch' and 'destroy' remember the event's real type.
+    struct Record {
+        static constexpr std::size_t InlineSize = 48;
+
+        std::uint64_t stamp;                         // Nanoseconds on the steady clock.
+        std::uint64_t origin;                        // Tracing stamp (0 when not tracing).
+        void (*dispatch)(EventBus&, const void*, std::uint64_t);
+        void (*destroy)(void*);
+        void* event;                                 // Points into 'storage'.
+        alignas(std::max_align_t) unsigned char storage[InlineSize];
+    };
+
+    // Records are appended into fixed-size blocks forming a singly linked list.
+    // The producer only touches the last block; the consumer frees blocks it has
+    // fully read once the producer has moved past them.
+    static constexpr std::size_t BlockSize = 1024;
+
+    struct Block {
+        Record records[BlockSize];
+        std::atomic<std::size_t> published{0};  // Records [0, published) are readable.
+        std::atomic<Block*> next{nullptr};
+    };
+
+    struct ProducerBuffer {
+        // Producer side.
+        Block* tail;
+        std::size_t tailIndex = 0;
+        // Consumer side.
+        Block* head;
+        std::size_t headIndex = 0;
+
+        ProducerBuffer() : tail(new Block), head(tail) {}
+        ~ProducerBuffer() {
+            while (const Record* record = front()) {
+                record->destroy(record->event);
+                pop();
+            }
+            delete head;
+        }
+
+        // Producer: reserve the next record slot, allocating a new block if needed.
+        Record& reserve() {
+            if (tailIndex == BlockSize) {
+                Block* block = new Block;
+                tail->next.store(block, std::memory_order_release);
+                tail = block;
+                tailIndex = 0;
+            }
+            return tail->records[tailIndex];
+        }
+
+        // Producer: make the record filled by reserve() visible to the consumer.
+        void publish() {
+            ++tailIndex;
+            tail->published.store(tailIndex, std::memory_order_release);
+        }
+
+        // Consumer: the oldest unread record, or nullptr if none is published yet.
+        const Record* front() {
+            if (headIndex == BlockSize) {
+                Block* next = head->next.load(std::memory_order_acquire);
+                if (next == nullptr) {
+                    return nullptr;
+                }
+                delete head;
+                head = next;
+                headIndex = 0;
+            }
+            if (headIndex < head->published.load(std::memory_order_acquire)) {
+                return &head->records[headIndex];
+            }
+            return nullptr;
+        }
+
+        // Consumer: discard the record returned by front().
+        void pop() { ++headIndex; }
+    };
+
+    EventBus& bus;
+    const std::uint64_t collectorId;
+
+    std::mutex registryMutex;                                // Guards 'producers'.
+    std::vector<std::unique_ptr<ProducerBuffer>> producers;  // One per producing thread.
+
+    // Reused between flushes so merging does not allocate.
+    std::vector<std::pair<std::uint64_t, std::size_t>> mergeHeap; // (stamp, producer)
+    std::vector<ProducerBuffer*> flushList;
+
+    static std::uint64_t now() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static std::uint64_t nextCollectorId() {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // localBuffer(): the calling thread's buffer for this collector. The first call
+    // on a thread registers a new buffer (under the registry mutex); afterwards the
+    // thread-local lookup is all that is needed.
+    ProducerBuffer& localBuffer() {
+        // Most threads feed a single collector, so remember the last one used.
+        thread_local std::uint64_t lastCollector = 0;
+        thread_local ProducerBuffer* lastBuffer = nullptr;
+        if (lastCollector == collectorId) {
+            return *lastBuffer;
+        }
+        thread_local std::unordered_map<std::uint64_t, ProducerBuffer*> buffers;
+        ProducerBuffer*& buffer = buffers[collectorId];
+        if (buffer == nullptr) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            producers.push_back(std::make_unique<ProducerBuffer>());
+            buffer = producers.back().get();
+        }
+        lastCollector = collectorId;
+        lastBuffer = buffer;
+        return *buffer;
+    }
+
+public:
+    explicit EventCollector(EventBus& bus) : bus(bus), collectorId(nextCollectorId()) {}
+
+    EventCollector(const EventCollector&) = delete;
+    EventCollector& operator=(const EventCollector&) = delete;
+
+    // collect(event): called from any thread. Copies the event into the calling
+    // thread's buffer; it will be emitted on the bus by the next flush().
+    template<typename TEvent>
+    void collect(const TEvent& event) {
+        ProducerBuffer& buffer = localBuffer();
+        Record& record = buffer.reserve();
+        record.stamp = now();
+        record.origin = EventTracer::instance().stamp();
+        if constexpr (sizeof(TEvent) <= Record::InlineSize && alignof(TEvent) <= alignof(std::max_align_t)) {
+            record.event = new (record.storage) TEvent(event);
+            record.dispatch = [](EventBus& target, const void* stored, std::uint64_t origin) {
+                target.emitFrom(origin, *static_cast<const TEvent*>(stored));
+            };
+            record.destroy = [](void* stored) { static_cast<TEvent*>(stored)->~TEvent(); };
+        } else {
+            // The slot is acquired on this thread and released on the flushing
+            // thread, so it goes home through the pool's lock-free remote stack.
+            using Ref = typename EventPool<TEvent>::Ref;
+            record.event = new (record.storage) Ref(EventPool<TEvent>::instance().acquire(event));
+            record.dispatch = [](EventBus& target, const void* stored, std::uint64_t origin) {
+                target.emitFrom(origin, **static_cast<const Ref*>(stored));
+            };
+            record.destroy = [](void* stored) { static_cast<Ref*>(stored)->~Ref(); };
+        }
+        buffer.publish();
+    }
+
+    // flush(): called from the dispatching thread (the one that owns the bus).
+    // Emits every record collected before the call, oldest first, and returns how
+    // many were emitted.
+    std::size_t flush() {
+        const std::uint64_t cutoff = now();
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            flushList.clear();
+            for (auto& producer : producers) {
+                flushList.push_back(producer.get());
+            }
+        }
+
+        // Min-heap keyed on each buffer's oldest stamp; ties go to the lower buffer index.
+        auto later = [](const std::pair<std::uint64_t, std::size_t>& a,
+                        const std::pair<std::uint64_t, std::size_t>& b) { return a > b; };
+        mergeHeap.clear();
+        for (std::size_t i = 0; i < flushList.size(); ++i) {
+            const Record* record = flushList[i]->front();
+            if (record != nullptr && record->stamp <= cutoff) {
+                mergeHeap.emplace_back(record->stamp, i);
+            }
+        }
+        std::make_heap(mergeHeap.begin(), mergeHeap.end(), later);
+
+        std::size_t emitted = 0;
+        while (!mergeHeap.empty()) {
+            std::pop_heap(mergeHeap.begin(), mergeHeap.end(), later);
+            std::size_t index = mergeHeap.back().second;
+            mergeHeap.pop_back();
+
+            ProducerBuffer& buffer = *flushList[index];
+            const Record* record = buffer.front();
+            record->dispatch(bus, record->event, record->origin);
+            record->destroy(record->event);
+            buffer.pop();
+            ++emitted;
+
+            // Put this buffer back into the merge if its next record is also old enough.
+            const Record* next = buffer.front();
+            if (next != nullptr && next->stamp <= cutoff) {
+                mergeHeap.emplace_back(next->stamp, index);
+                std::push_heap(mergeHeap.begin(), mergeHeap.end(), later);
+            }
+        }
+        return emitted;
+    }
+};
+
+// --- Channels: Topic-Scoped Delivery with Wildcards ---
+// EventBus delivers every TEvent to every TEvent listener. When listeners care
+// about one room or one entity, each of them has to inspect every event and
+// ignore most of them. A ChannelBus scopes delivery by a channel name:
+//
+//     channels.subscribe<PlayerMovedEvent>("room/12/player", handler);
+//     channels.emit(channels.channel("room/12/player"), event);
+//
+// Names are '/'-separated segments. Patterns may use two wildcards:
+//   '*'  matches exactly one segment:            room/*/player
+//   '#'  (last segment only) matches zero or more: room/12/#
+//
+// Subscription patterns form a trie (one per event type). Walking a trie on every
+// emit would be slow, so it is "compiled" instead: every known channel is matched
+// against the trie once, and the results are stored as a flat table
+//     offsets[channel] .. offsets[channel + 1]  ->  indices into 'matches'
+// of the subscriptions that channel reaches. An emit is then a couple of indexed
+// loads plus the handler calls. Subscribing or unsubscribing marks the table
+// stale, and the next emit recompiles it, removing dead subscriptions so churn
+// does not grow the route; a channel created after the last compile is matched
+// on its own and appended as a new row.
+
+// Channel: a handle to an interned channel name (see ChannelBus::channel).
+struct Channel {
+    std::uint32_t id = 0;
+};
+
+class ChannelBus {
+private:
+    using Segments = std::vector<std::uint32_t>; // Symbol IDs of the name's segments.
+
+    struct Subscription {
+        std::function<void(const void*)> call;
+        std::weak_ptr<void> owner;
+        bool bound = false; // True for subscribeScoped: 'owner' decides the lifetime.
+        Segments pattern;   // With Star/Tail for the wildcards.
+        bool live() const { return !bound || !owner.expired(); }
+    };
+
+    // Trie node, used only while compiling.
+    struct Node {
+        std::unordered_map<std::uint32_t, std::uint32_t> children; // Literal segment -> node.
+        std::int32_t star = -1;                  // Child for '*'.
+        std::vector<std::uint32_t> here;         // Subscriptions whose pattern ends here.
+        std::vector<std::uint32_t> tail;         // Subscriptions ending in '#' here.
+    };
+
+    // Route: everything for one event type.
+    struct Route {
+        std::deque<Subscription> subscriptions;  // Stable addresses: emit may run while
+                                                 // a handler subscribes more.
+        std::vector<Node> trie;
+        std::vector<std::uint32_t> offsets{0};   // One row per compiled channel.
+        std::vector<std::uint32_t> matches;
+        bool stale = false;
+    };
+
+    static constexpr std::uint32_t Star = 0xFFFFFFFEu;
+    static constexpr std::uint32_t Tail = 0xFFFFFFFFu;
+
+    std::unordered_map<std::string, std::uint32_t> channelIds;
+    std::vector<Segments> channels;
+    std::map<void*, Route> routes;
+    int emitting = 0; // Nesting depth of emit(); full recompiles wait for depth 0.
+
+    template<typename TEvent>
+    static void* getTypeKey() {
+        static char key;
+        return &key;
+    }
+
+    static Segments split(const std::string& name, bool pattern) {
+        Segments segments;
+        std::size_t start = 0;
+        for (;;) {
+            std::size_t end = name.find('/', start);
+            std::string segment = name.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if (pattern && segment == "*") {
+                segments.push_back(Star);
+            } else if (pattern && segment == "#") {
+                if (end != std::string::npos) {
+                    throw std::invalid_argument("ChannelBus: '#' must be the last segment of " + name);
+                }
+                segments.push_back(Tail);
+            } else {
+                segments.push_back(SymbolTable::global().intern(segment));
+            }
+            if (end == std::string::npos) {
+                return segments;
+            }
+            start = end + 1;
+        }
+    }
+
+    static void buildTrie(Route& route) {
+        route.trie.assign(1, Node{});
+        for (std::uint32_t index = 0; index < route.subscriptions.size(); ++index) {
+            const Subscription& subscription = route.subscriptions[index];
+            std::uint32_t node = 0;
+            for (std::uint32_t segment : subscription.pattern) {
+                if (segment == Tail) {
+                    break;
+                }
+                std::uint32_t next;
+                if (segment == Star) {
+                    if (route.trie[node].star < 0) {
+                        route.trie[node].star = static_cast<std::int32_t>(route.trie.size());
+                        route.trie.emplace_back();
+                    }
+                    next = static_cast<std::uint32_t>(route.trie[node].star);
+                } else {
+                    auto found = route.trie[node].children.find(segment);
+                    if (found == route.trie[node].children.end()) {
+                        next = static_cast<std::uint32_t>(route.trie.size());
+                        route.trie[node].children.emplace(segment, next);
+                        route.trie.emplace_back();
+                    } else {
+                        next = found->second;
+                    }
+                }
+                node = next;
+            }
+            if (!subscription.pattern.empty() && subscription.pattern.back() == Tail) {
+                route.trie[node].tail.push_back(index);
+            } else {
+                route.trie[node].here.push_back(index);
+            }
+        }
+    }
+
+    static void match(const Route& route, std::uint32_t node, const Segments& name, std::size_t depth,
+                      std::vector<std::uint32_t>& out) {
+        const Node& current = route.trie[node];
+        out.insert(out.end(), current.tail.begin(), current.tail.end());
+        if (depth == name.size()) {
+            out.insert(out.end(), current.here.begin(), current.here.end());
+            return;
+        }
+        auto child = current.children.find(name[depth]);
+        if (child != current.children.end()) {
+            match(route, child->second, name, depth + 1, out);
+        }
+        if (current.star >= 0) {
+            match(route, static_cast<std::uint32_t>(current.star), name, depth + 1, out);
+        }
+    }
+
+    // appendRow: matches channel 'channel' (the next uncompiled one) against the trie.
+    void appendRow(Route& route, std::uint32_t channel) {
+        const std::size_t rowStart = route.matches.size();
+        match(route, 0, channels[channel], 0, route.matches);
+        std::sort(route.matches.begin() + rowStart, route.matches.end()); // Subscription order.
+        route.offsets.push_back(static_cast<std::uint32_t>(route.matches.size()));
+    }
+
+    // compile: drops dead subscriptions (keeping the others in order, so indices
+    // still follow subscription order) and rebuilds the trie and the table. Only
+    // called when no emit is running, so nothing holds a subscription index.
+    void compile(Route& route) {
+        route.subscriptions.erase(std::remove_if(route.subscriptions.begin(), route.subscriptions.end(),
+                                                 [](const Subscription& subscription) { return !subscription.live(); }),
+                                  route.subscriptions.end());
+        buildTrie(route);
+        route.offsets.assign(1, 0);
+        route.matches.clear();
+        for (std::uint32_t channel = 0; channel < channels.size(); ++channel) {
+            appendRow(route, channel);
+        }
+        route.stale = false;
+    }
+
+    template<typename TEvent>
+    Route& subscribeTo(const std::string& pattern, std::function<void(const TEvent&)> handler,
+                       std::shared_ptr<void> owner) {
+        Route& route = routes[getTypeKey<TEvent>()];
+        Subscription subscription;
+        subscription.call = [handler = std::move(handler)](const void* event) {
+            handler(*static_cast<const TEvent*>(event));
+        };
+        subscription.bound = owner != nullptr;
+        subscription.owner = owner;
+        subscription.pattern = split(pattern, true);
+        route.subscriptions.push_back(std::move(subscription));
+        route.stale = true;
+        return route;
+    }
+
+public:
+    ChannelBus() = default;
+    ChannelBus(const ChannelBus&) = delete;
+    ChannelBus& operator=(const ChannelBus&) = delete;
+
+    // channel(name): the handle for a channel name, registering it on first use.
+    // Keep handles for hot channels rather than looking names up on every emit.
+    Channel channel(const std::string& name) {
+        auto found = channelIds.find(name);
+        if (found != channelIds.end()) {
+            return Channel{found->second};
+        }
+        const auto id = static_cast<std::uint32_t>(channels.size());
+        channels.push_back(split(name, false));
+        channelIds.emplace(name, id);
+        return Channel{id};
+    }
+
+    std::size_t channelCount() const { return channels.size(); }
+
+    // subscribe<TEvent>(pattern, handler): 'handler' receives every TEvent emitted
+    // on a channel matching 'pattern'.
+    template<typename TEvent>
+    void subscribe(const std::string& pattern, std::function<void(const TEvent&)> handler) {
+        subscribeTo<TEvent>(pattern, std::move(handler), nullptr);
+    }
+
+    // subscribeScoped<TEvent>(pattern, handler): as subscribe(), for as long as
+    // the returned token is alive.
+    template<typename TEvent>
+    ListenerToken subscribeScoped(const std::string& pattern, std::function<void(const TEvent&)> handler) {
+        auto lifetime = std::make_shared<char>();
+        subscribeTo<TEvent>(pattern, std::move(handler), lifetime);
+        return ListenerToken(std::move(lifetime));
+    }
+
+    // emit(channel, event): delivers 'event' to the subscriptions matching 'channel',
+    // in the order they subscribed. Returns the number of handlers called.
+    template<typename TEvent>
+    std::size_t emit(Channel channel, const TEvent& event) {
+        auto found = routes.find(getTypeKey<TEvent>());
+        if (found == routes.end()) {
+            return 0;
+        }
+        Route& route = found->second;
+        if (route.stale && emitting == 0) {
+            compile(route);
+        }
+        while (route.offsets.size() <= channel.id + 1) {
+            appendRow(route, static_cast<std::uint32_t>(route.offsets.size() - 1));
+        }
+        ++emitting;
+        std::size_t called = 0;
+        // Indices, not iterators: a handler may register a channel, which appends rows.
+        for (std::uint32_t i = route.offsets[channel.id]; i < route.offsets[channel.id + 1]; ++i) {
+            const Subscription& subscription = route.subscriptions[route.matches[i]];
+            if (!subscription.live()) {
+                route.stale = true; // Dropped at the next compile.
+                continue;
+            }
+            subscription.call(&event);
+            ++called;
+        }
+        --emitting;
+        return called;
+    }
+
+    template<typename TEvent>
+    std::size_t emit(const std::string& name, const TEvent& event) {
+        return emit(channel(name), event);
+    }
+};
+
+// --- Event Bridges: Forwarding Events to Other Processes ---
+// A replay inspector or a separate AI worker process can listen to the game's bus
+// through a socket. EventBridgeSender subscribes to chosen event types on a local
+// bus and writes them, serialized with EventCodec, to a Unix domain socket or a
+// loopback TCP connection. EventBridgeReceiver accepts connections, decodes what
+// arrives and re-emits it on its own bus.
+//
+// Wire format: the sender collects events into batches and sends each batch as
+//     [u32 batch bytes][u32 event count] then, per event, [u32 type tag][u32 size][payload]
+// The batch header and body go out in one sendmsg() call, and a batch is written
+// when it reaches 'batchBytes' or on flush(), so a burst of small events costs one
+// system call instead of one per event. The per-event size lets a receiver skip
+// types it has not registered. Writes use MSG_NOSIGNAL, so a receiver that goes
+// away surfaces as a std::system_error (EPIPE) instead of a SIGPIPE that would
+// kill the sending process.
+//
+// The receiver multiplexes its listening socket and every connection through one
+// epoll set. poll() is called by the thread that owns the receiving bus (like
+// Mailbox::drain), so events are emitted on that thread. A connection that sends
+// a corrupt batch header, or more new Symbol strings than the receiver allows all
+// peers together (every one is interned for good), is closed; the others keep
+// being served.
+//
+// POSIX sockets + epoll: Linux only.
+#if defined(__linux__)
+
+// Both ends frame data the same way.
+struct BridgeFrame {
+    static constexpr std::size_t BatchHeader = 2 * sizeof(std::uint32_t); // bytes, count
+    static constexpr std::size_t EventHeader = 2 * sizeof(std::uint32_t); // tag, size
+    static constexpr std::uint32_t MaxBatch = 64u << 20;                  // Sanity limit.
+};
+
+class EventBridgeSender {
+private:
+    int socketFd = -1;
+    std::size_t batchBytes;
+    std::vector<char> batch;       // Events of the batch being built (body only).
+    std::uint32_t batchEvents = 0;
+    std::vector<ListenerToken> forwarding;
+
+    EventBridgeSender(int fd, std::size_t batchBytes) : socketFd(fd), batchBytes(batchBytes) {
+        batch.reserve(batchBytes + 256);
+    }
+
+    static int connectTo(const sockaddr* address, socklen_t length, int family) {
+        int fd = ::socket(family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "EventBridgeSender: socket");
+        }
+        if (::connect(fd, address, length) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "EventBridgeSender: connect");
+        }
+        return fd;
+    }
+
+    // writeAll: sendmsg() until every byte of 'parts' is written.
+    void writeAll(iovec* parts, int count) {
+        while (count > 0) {
+            msghdr message{};
+            message.msg_iov = parts;
+            message.msg_iovlen = static_cast<std::size_t>(count);
+            ssize_t written = ::sendmsg(socketFd, &message, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "EventBridgeSender: sendmsg");
+            }
+            auto remaining = static_cast<std::size_t>(written);
+            while (count > 0 && remaining >= parts->iov_len) {
+                remaining -= parts->iov_len;
+                ++parts;
+                --count;
+            }
+            if (count > 0) {
+                parts->iov_base = static_cast<char*>(parts->iov_base) + remaining;
+                parts->iov_len -= remaining;
+            }
+        }
+    }
+
+public:
+    // connectUnix(path) / connectTcp(port): connect to a receiver on this machine.
+    // A batch is sent once it holds at least 'batchBytes' bytes.
+    static std::unique_ptr<EventBridgeSender> connectUnix(const std::string& path, std::size_t batchBytes = 64 * 1024) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::length_error("EventBridgeSender: socket path too long");
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        int fd = connectTo(reinterpret_cast<const sockaddr*>(&address), sizeof address, AF_UNIX);
+        return std::unique_ptr<EventBridgeSender>(new EventBridgeSender(fd, batchBytes));
+    }
+
+    static std::unique_ptr<EventBridgeSender> connectTcp(std::uint16_t port, std::size_t batchBytes = 64 * 1024) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int fd = connectTo(reinterpret_cast<const sockaddr*>(&address), sizeof address, AF_INET);
+        int noDelay = 1; // Batching already coalesces writes; don't let Nagle delay flushes.
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof noDelay);
+        return std::unique_ptr<EventBridgeSender>(new EventBridgeSender(fd, batchBytes));
+    }
+
+    EventBridgeSender(const EventBridgeSender&) = delete;
+    EventBridgeSender& operator=(const EventBridgeSender&) = delete;
+
+    ~EventBridgeSender() {
+        forwarding.clear(); // Stop forwarding before the socket goes away.
+        try {
+            flush();
+        } catch (const std::system_error&) {
+            // The receiver is gone; nothing left to deliver to.
+        }
+        ::close(socketFd);
+    }
+
+    // send(event): adds one event to the current batch.
+    template<typename TEvent>
+    void send(const TEvent& event) {
+        using Codec = EventCodec<TEvent>;
+        const auto size = static_cast<std::uint32_t>(Codec::size(event));
+        const std::size_t at = batch.size();
+        batch.resize(at + BridgeFrame::EventHeader + size);
+        char* out = batch.data() + at;
+        std::memcpy(out, &Codec::tag, sizeof(std::uint32_t));
+        std::memcpy(out + sizeof(std::uint32_t), &size, sizeof size);
+        Codec::write(out + BridgeFrame::EventHeader, event);
+        ++batchEvents;
+        if (batch.size() >= batchBytes) {
+            flush();
+        }
+    }
+
+    // forward<TEvent>(bus): sends every TEvent emitted on 'bus' until this sender
+    // is destroyed.
+    template<typename TEvent>
+    void forward(EventBus& bus) {
+        forwarding.push_back(bus.subscribeScoped<TEvent>([this](const TEvent& event) { send(event); }));
+    }
+
+    // flush(): writes the current batch, if any. The batch is emptied once the
+    // write is over, even if it failed: a partly sent batch cannot be resent.
+    void flush() {
+        if (batchEvents == 0) {
+            return;
+        }
+        struct ClearGuard {
+            EventBridgeSender& sender;
+            ~ClearGuard() {
+                sender.batch.clear();
+                sender.batchEvents = 0;
+            }
+        } clear{*this};
+        std::uint32_t header[2] = {static_cast<std::uint32_t>(batch.size()), batchEvents};
+        iovec parts[2] = {{header, sizeof header}, {batch.data(), batch.size()}};
+        writeAll(parts, 2);
+    }
+};
+
+class EventBridgeReceiver {
+private:
+    struct Connection {
+        int fd;
+        std::vector<char> inbox; // Bytes received but not yet decoded, at the front.
+        std::size_t pending = 0;
+    };
+
+    // Decoded: what a decoder did with one event. Refused means the connection
+    // must be dropped: it exhausted the symbol allowance, or decoding threw.
+    enum class Decoded { Emitted, Malformed, Refused };
+    using Decoder = Decoded (*)(ByteReader&, EventBus&);
+
+    // New Symbol strings all peers together may add to the process-wide table.
+    static constexpr std::size_t MaxPeerSymbols = 64 * 1024;
+
+    EventBus& bus;
+    int listenFd = -1;
+    int epollFd = -1;
+    std::uint16_t boundPort = 0;
+    std::string unixPath;
+    std::unordered_map<std::uint32_t, Decoder> decoders;       // type tag -> decode + emit
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::size_t received = 0;
+    std::size_t skipped = 0;
+    std::size_t dropped = 0; // Connections closed for corrupt or refused input.
+    std::size_t symbolAllowance = MaxPeerSymbols;
+
+    EventBridgeReceiver(EventBus& bus, int fd) : bus(bus), listenFd(fd) {
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            int error = errno;
+            ::close(listenFd);
+            throw std::system_error(error, std::generic_category(), "EventBridgeReceiver: epoll_create1");
+        }
+        if (!watch(listenFd, nullptr)) {
+            int error = errno;
+            ::close(epollFd);
+            ::close(listenFd);
+            throw std::system_error(error, std::generic_category(), "EventBridgeReceiver: epoll_ctl");
+        }
+    }
+
+    // watch: adds 'fd' to the epoll set; false (with errno set) if that failed.
+    bool watch(int fd, Connection* connection) {
+        epoll_event interest{};
+        interest.events = EPOLLIN;
+        interest.data.ptr = connection; // nullptr marks the listening socket.
+        return ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &interest) == 0;
+    }
+
+    static int listenOn(const sockaddr* address, socklen_t length, int family) {
+        int fd = ::socket(family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "EventBridgeReceiver: socket");
+        }
+        int reuse = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof reuse);
+        if (::bind(fd, address, length) != 0 || ::listen(fd, 16) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "EventBridgeReceiver: bind/listen");
+        }
+        return fd;
+    }
+
+    void acceptAll() {
+        for (;;) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return; // EAGAIN: no more pending connections.
+            }
+            auto connection = std::make_unique<Connection>();
+            connection->fd = fd;
+            connection->inbox.resize(256 * 1024);
+            if (!watch(fd, connection.get())) {
+                ::close(fd); // Could never be polled; don't keep it.
+                continue;
+            }
+            connections.emplace(fd, std::move(connection));
+        }
+    }
+
+    // readAll: reads until the socket is empty, decoding complete batches as they
+    // arrive. Returns false when the connection should be closed: the peer closed
+    // it, sent a batch header that makes the rest of its stream unreadable, or sent
+    // an event that was refused (see Decoded).
+    bool readAll(Connection& connection) {
+        std::size_t filled = connection.pending;
+        std::size_t start = 0; // First undecoded byte.
+        bool open = true;
+        for (;;) {
+            if (filled == connection.inbox.size()) {
+                if (start > 0) {
+                    std::memmove(connection.inbox.data(), connection.inbox.data() + start, filled - start);
+                    filled -= start;
+                    start = 0;
+                } else {
+                    connection.inbox.resize(connection.inbox.size() * 2); // One batch is larger than the inbox.
+                }
+            }
+            ssize_t got = ::read(connection.fd, connection.inbox.data() + filled, connection.inbox.size() - filled);
+            if (got > 0) {
+                filled += static_cast<std::size_t>(got);
+                start = decodeBatches(connection, start, filled);
+                if (start == Drop) {
+                    ++dropped;
+                    return false;
+                }
+                if (start == filled) {
+                    start = filled = 0; // Everything decoded: reuse the inbox from the front.
+                }
+                continue;
+            }
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            open = got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+        // Keep only the undecoded tail, at the front of the inbox.
+        std::memmove(connection.inbox.data(), connection.inbox.data() + start, filled - start);
+        connection.pending = filled - start;
+        return open;
+    }
+
+    static constexpr std::size_t Drop = static_cast<std::size_t>(-1);
+
+    // decodeBatches: emits every complete batch in inbox[start, filled) and returns
+    // the offset of the first incomplete one, or Drop if the connection has to go:
+    // a batch header is impossible (the stream cannot be resynchronised after
+    // that) or an event was refused.
+    std::size_t decodeBatches(Connection& connection, std::size_t start, std::size_t filled) {
+        const char* data = connection.inbox.data();
+        while (filled - start >= BridgeFrame::BatchHeader) {
+            std::uint32_t header[2];
+            std::memcpy(header, data + start, sizeof header);
+            if (header[0] > BridgeFrame::MaxBatch) {
+                return Drop;
+            }
+            if (filled - start < BridgeFrame::BatchHeader + header[0]) {
+                break;
+            }
+            ByteReader body(data + start + BridgeFrame::BatchHeader, header[0]);
+            for (std::uint32_t i = 0; i < header[1]; ++i) {
+                std::uint32_t event[2];
+                if (!body.read(event, sizeof event)) {
+                    break;
+                }
+                ByteReader payload(body.position(), std::min<std::size_t>(event[1], body.remaining()));
+                payload.limitSymbols(&symbolAllowance);
+                body.view(payload.remaining());
+                auto decoder = decoders.find(event[0]);
+                const Decoded decoded = decoder != decoders.end() ? decoder->second(payload, bus) : Decoded::Malformed;
+                if (decoded == Decoded::Refused) {
+                    return Drop;
+                }
+                if (decoded == Decoded::Emitted) {
+                    ++received;
+                } else {
+                    ++skipped;
+                }
+            }
+            start += BridgeFrame::BatchHeader + header[0];
+        }
+        return start;
+    }
+
+    void close(Connection& connection) {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::close(connection.fd);
+        connections.erase(connection.fd);
+    }
+
+public:
+    // listenUnix(bus, path) / listenTcp(bus, port): accept senders on a Unix domain
+    // socket or on 127.0.0.1:port (0 picks a free port; see port()).
+    static std::unique_ptr<EventBridgeReceiver> listenUnix(EventBus& bus, const std::string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::length_error("EventBridgeReceiver: socket path too long");
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        ::unlink(path.c_str()); // A stale socket file from an earlier run.
+        int fd = listenOn(reinterpret_cast<const sockaddr*>(&address), sizeof address, AF_UNIX);
+        std::unique_ptr<EventBridgeReceiver> receiver(new EventBridgeReceiver(bus, fd));
+        receiver->unixPath = path;
+        return receiver;
+    }
+
+    static std::unique_ptr<EventBridgeReceiver> listenTcp(EventBus& bus, std::uint16_t port = 0) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int fd = listenOn(reinterpret_cast<const sockaddr*>(&address), sizeof address, AF_INET);
+        socklen_t length = sizeof address;
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        std::unique_ptr<EventBridgeReceiver> receiver(new EventBridgeReceiver(bus, fd));
+        receiver->boundPort = ntohs(address.sin_port);
+        return receiver;
+    }
+
+    EventBridgeReceiver(const EventBridgeReceiver&) = delete;
+    EventBridgeReceiver& operator=(const EventBridgeReceiver&) = delete;
+
+    ~EventBridgeReceiver() {
+        for (auto& entry : connections) {
+            ::close(entry.first);
+        }
+        ::close(epollFd);
+        ::close(listenFd);
+        if (!unixPath.empty()) {
+            ::unlink(unixPath.c_str());
+        }
+    }
+
+    std::uint16_t port() const { return boundPort; }
+
+    // accept<TEvent>(): re-emit incoming TEvents on the bus. Other types are skipped.
+    // Exceptions from decoding (e.g. a full SymbolTable) drop only the connection
+    // that sent the event; exceptions from the bus's listeners still propagate.
+    template<typename TEvent>
+    void accept() {
+        decoders[EventCodec<TEvent>::tag] = [](ByteReader& in, EventBus& target) {
+            TEvent event{};
+            try {
+                if (!deserialize(in, event)) {
+                    return in.refusedSymbol() ? Decoded::Refused : Decoded::Malformed;
+                }
+            } catch (const std::exception&) {
+                return Decoded::Refused;
+            }
+            target.emit(event);
+            return Decoded::Emitted;
+        };
+    }
+
+    // poll(timeoutMs): waits up to 'timeoutMs' (-1: forever) for traffic, then
+    // accepts new senders and emits everything that arrived. Returns the number of
+    // events emitted.
+    std::size_t poll(int timeoutMs = 0) {
+        epoll_event ready[32];
+        int count = ::epoll_wait(epollFd, ready, 32, timeoutMs);
+        const std::size_t before = received;
+        for (int i = 0; i < count; ++i) {
+            auto* connection = static_cast<Connection*>(ready[i].data.ptr);
+            if (connection == nullptr) {
+                acceptAll();
+            } else if (!readAll(*connection)) {
+                close(*connection);
+            }
+        }
+        return received - before;
+    }
+
+    std::size_t connectionCount() const { return connections.size(); }
+    std::size_t receivedCount() const { return received; }
+    std::size_t skippedCount() const { return skipped; } // Unregistered or malformed events.
+    std::size_t droppedCount() const { return dropped; } // Connections closed as corrupt or refused.
+};
+
+#endif // __linux__
+
+// --- Event Journal: Persisting the Emit Stream ---
+// Event sourcing: if every state-changing event is journaled, state can be rebuilt
+// after a restart by emitting the journal again. Replaying gigabytes from the
+// beginning is slow, so the journal also stores snapshots of listener-owned state;
+// a restart loads the newest snapshot and replays only the events after it.
+//
+// On disk, a journal is a directory of
+//   <first sequence>.seg  : append-only segments of [u32 type tag][u32 size][payload]
+//                           records; a new segment starts every 'segmentBytes'.
+//   <sequence>.snap       : a state snapshot taken after 'sequence' events, headed
+//                           by the segment and byte offset where the next event
+//                           starts, so a restore seeks straight to the tail.
+// Sequence numbers count journaled events from 0, across segments.
+//
+// Usage:
+//   1. journal.replay<TEvent>() for each journaled type, then
+//      journal.restore(state, bus): loads the newest snapshot into 'state' and
+//      emits the events after it on 'bus' (segments are read through mmap).
+//   2. Subscribe the listeners that update 'state', THEN journal.record<TEvent>(bus),
+//      so a journaled event is already reflected in 'state'. Recording after
+//      restoring also keeps the replayed events from being journaled twice.
+//   3. journal.snapshotEvery(n, state) writes a snapshot every n events;
+//      journal.snapshot(state) writes one now. compact() deletes the segments and
+//      snapshots the newest snapshot has made redundant.
+//
+// Records are buffered and written with write(); sync() also fdatasync()s them.
+// A record torn by a crash ends the replay of its segment.
+#if defined(__linux__)
+
+class EventJournal {
+private:
+    using Decoder = bool (*)(ByteReader&, EventBus&);
+    static constexpr std::size_t RecordHeader = 2 * sizeof(std::uint32_t); // tag, size
+
+    std::filesystem::path directory;
+    std::size_t segmentBytes;
+    int segmentFd = -1;
+    std::uint64_t segmentFirst = 0;   // Sequence of the open segment's first record.
+    std::size_t segmentSize = 0;      // Bytes in the open segment, including 'buffer'.
+    std::vector<char> buffer;         // Records not yet written to the segment.
+    std::uint64_t sequence = 0;       // Events journaled so far (next sequence number).
+    std::unordered_map<std::uint32_t, Decoder> decoders;
+    std::vector<ListenerToken> recording;
+    std::function<void()> periodicSnapshot;
+    std::uint64_t snapshotPeriod = 0;
+
+    static std::filesystem::path numbered(const std::filesystem::path& directory, std::uint64_t number,
+                                          const char* extension) {
+        std::string name = std::to_string(number);
+        name.insert(0, 20 - name.size(), '0'); // Zero-padded, so names sort by number.
+        return directory / (name + extension);
+    }
+
+    // files(extension): (number, path) of every file with that extension, in order.
+    std::vector<std::pair<std::uint64_t, std::filesystem::path>> files(const char* extension) const {
+        std::vector<std::pair<std::uint64_t, std::filesystem::path>> found;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.path().extension() == extension) {
+                found.emplace_back(std::stoull(entry.path().stem().string()), entry.path());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+
+    // MappedFile: a read-only mmap of a whole file.
+    struct MappedFile {
+        const char* data = nullptr;
+        std::size_t size = 0;
+
+        explicit MappedFile(const std::filesystem::path& path) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), "EventJournal: open " + path.string());
+            }
+            struct stat info{};
+            ::fstat(fd, &info);
+            size = static_cast<std::size_t>(info.st_size);
+            if (size != 0) {
+                void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "EventJournal: mmap");
+                }
+                ::madvise(mapped, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapped);
+            }
+            ::close(fd);
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() {
+            if (data != nullptr) {
+                ::munmap(const_cast<char*>(data), size);
+            }
+        }
+    };
+
+    // completeRecords(data, size, offset): how many whole records the segment holds
+    // after 'offset', and where the last one ends.
+    static std::pair<std::uint64_t, std::size_t> completeRecords(const char* data, std::size_t size,
+                                                                 std::size_t offset) {
+        std::uint64_t records = 0;
+        offset = std::min(offset, size);
+        while (size - offset >= RecordHeader) {
+            std::uint32_t payload;
+            std::memcpy(&payload, data + offset + sizeof(std::uint32_t), sizeof payload);
+            if (size - offset - RecordHeader < payload) {
+                break;
+            }
+            offset += RecordHeader + payload;
+            ++records;
+        }
+        return {records, offset};
+    }
+
+    static void writeFully(int fd, const char* data, std::size_t size) {
+        std::size_t written = 0;
+        while (written < size) {
+            ssize_t result = ::write(fd, data + written, size - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "EventJournal: write");
+            }
+            written += static_cast<std::size_t>(result);
+        }
+    }
+
+    void writeBuffer() {
+        writeFully(segmentFd, buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+    // syncDirectory(): makes renames and new files in the journal directory durable.
+    void syncDirectory() const {
+        int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "EventJournal: open " + directory.string());
+        }
+        int result = ::fsync(fd);
+        int error = errno;
+        ::close(fd);
+        if (result != 0) {
+            throw std::system_error(error, std::generic_category(), "EventJournal: fsync " + directory.string());
+        }
+    }
+
+    void openSegment() {
+        if (segmentFd >= 0) {
+            writeBuffer();
+            ::close(segmentFd);
+        }
+        const auto path = numbered(directory, sequence, ".seg");
+        segmentFirst = sequence;
+        segmentFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (segmentFd < 0) {
+            throw std::system_error(errno, std::generic_category(), "EventJournal: create " + path.string());
+        }
+        segmentSize = 0;
+    }
+
+public:
+    // EventJournal(directory, segmentBytes): opens (or creates) a journal. Appending
+    // continues after the last complete record already in the directory.
+    explicit EventJournal(const std::filesystem::path& directory, std::size_t segmentBytes = 64u << 20)
+        : directory(directory), segmentBytes(segmentBytes) {
+        std::filesystem::create_directories(directory);
+        buffer.reserve(1 << 20);
+        auto segments = files(".seg");
+        if (!segments.empty()) {
+            // Count the last segment's records, dropping a torn tail. When the newest
+            // snapshot points into this segment, counting starts there.
+            const auto& last = segments.back();
+            std::uint64_t counted = last.first;
+            std::size_t offset = 0;
+            auto snapshots = files(".snap");
+            std::uint64_t position[2];
+            std::ifstream newest(snapshots.empty() ? std::filesystem::path() : snapshots.back().second, std::ios::binary);
+            if (newest.read(reinterpret_cast<char*>(position), sizeof position) && position[0] == last.first) {
+                counted = snapshots.back().first;
+                offset = position[1];
+            }
+            std::pair<std::uint64_t, std::size_t> complete{0, 0};
+            {
+                MappedFile file(last.second);
+                complete = completeRecords(file.data, file.size, offset);
+            }
+            std::filesystem::resize_file(last.second, complete.second);
+            sequence = counted + complete.first;
+        }
+        openSegment();
+    }
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    ~EventJournal() {
+        recording.clear();
+        try {
+            writeBuffer();
+        } catch (const std::system_error&) {
+            // Nowhere left to report it.
+        }
+        ::close(segmentFd);
+    }
+
+    std::uint64_t size() const { return sequence; }
+
+    // append(event): journals one event.
+    template<typename TEvent>
+    void append(const TEvent& event) {
+        using Codec = EventCodec<TEvent>;
+        const auto payload = static_cast<std::uint32_t>(Codec::size(event));
+        if (segmentSize >= segmentBytes) {
+            openSegment();
+        }
+        const std::size_t at = buffer.size();
+        buffer.resize(at + RecordHeader + payload);
+        char* out = buffer.data() + at;
+        std::memcpy(out, &Codec::tag, sizeof(std::uint32_t));
+        std::memcpy(out + sizeof(std::uint32_t), &payload, sizeof payload);
+        Codec::write(out + RecordHeader, event);
+        segmentSize += RecordHeader + payload;
+        ++sequence;
+        if (buffer.size() >= (1 << 20)) {
+            writeBuffer();
+        }
+        if (snapshotPeriod != 0 && sequence % snapshotPeriod == 0) {
+            periodicSnapshot();
+        }
+    }
+
+    // record<TEvent>(bus): journals every TEvent emitted on 'bus' from now on.
+    template<typename TEvent>
+    void record(EventBus& bus) {
+        recording.push_back(bus.subscribeScoped<TEvent>([this](const TEvent& event) { append(event); }));
+    }
+
+    // flush() hands buffered records to the OS; sync() also makes them durable
+    // (throwing std::system_error if the disk could not confirm it).
+    void flush() { writeBuffer(); }
+    void sync() {
+        writeBuffer();
+        if (::fdatasync(segmentFd) != 0) {
+            throw std::system_error(errno, std::generic_category(), "EventJournal: fdatasync");
+        }
+    }
+
+    // snapshot(state): writes 'state' (a type with EVENT_FIELDS) as of the current
+    // sequence. The segment is synced first, so the position the snapshot records
+    // is never past the segment's durable end. The file is written and
+    // fdatasync()ed under a temporary name, then renamed, and the directory is
+    // fsync()ed, so a crash never leaves a partial snapshot: after one, either the
+    // old set of snapshots or the new one is on disk.
+    template<typename TState>
+    void snapshot(const TState& state) {
+        sync();
+        std::vector<char> bytes;
+        const std::uint64_t position[2] = {segmentFirst, segmentSize};
+        bytes.resize(sizeof position);
+        std::memcpy(bytes.data(), position, sizeof position);
+        serialize(bytes, state);
+        const auto path = numbered(directory, sequence, ".snap");
+        const auto temporary = path.string() + ".tmp";
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "EventJournal: open " + temporary);
+        }
+        try {
+            writeFully(fd, bytes.data(), bytes.size());
+            if (::fdatasync(fd) != 0) {
+                throw std::system_error(errno, std::generic_category(), "EventJournal: fdatasync " + temporary);
+            }
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        std::filesystem::rename(temporary, path);
+        syncDirectory();
+    }
+
+    // snapshotEvery(events, state): snapshot(state) after every 'events' events
+    // (0 turns it off). 'state' must outlive the journal or a later call.
+    template<typename TState>
+    void snapshotEvery(std::uint64_t events, const TState& state) {
+        snapshotPeriod = events;
+        periodicSnapshot = [this, &state] { snapshot(state); };
+    }
+
+    // replay<TEvent>(): restore() re-emits journaled TEvents (other types are skipped).
+    template<typename TEvent>
+    void replay() {
+        decoders[EventCodec<TEvent>::tag] = [](ByteReader& in, EventBus& target) {
+            TEvent event{};
+            if (!deserialize(in, event)) {
+                return false;
+            }
+            target.emit(event);
+            return true;
+        };
+    }
+
+    // restore(state, bus): loads the newest snapshot into 'state' (if there is
+    // one) and emits every later event on 'bus'. Returns the number of events
+    // replayed.
+    template<typename TState>
+    std::uint64_t restore(TState& state, EventBus& bus) {
+        writeBuffer();
+        std::uint64_t from = 0;
+        std::uint64_t position[2] = {0, 0}; // Segment and offset of event 'from'.
+        auto snapshots = files(".snap");
+        if (!snapshots.empty()) {
+            MappedFile file(snapshots.back().second);
+            ByteReader in(file.data, file.size);
+            if (!in.read(position, sizeof position) || !deserialize(in, state)) {
+                throw std::runtime_error("EventJournal: corrupt snapshot " + snapshots.back().second.string());
+            }
+            from = snapshots.back().first;
+        }
+
+        std::uint64_t replayed = 0;
+        for (const auto& segment : files(".seg")) {
+            if (segment.first < position[0]) {
+                continue; // Entirely covered by the snapshot.
+            }
+            MappedFile file(segment.second);
+            std::uint64_t current = segment.first;
+            std::size_t offset = 0;
+            if (segment.first == position[0]) {
+                current = from;
+                offset = std::min<std::size_t>(position[1], file.size);
+            }
+            while (file.size - offset >= RecordHeader) {
+                std::uint32_t header[2];
+                std::memcpy(header, file.data + offset, sizeof header);
+                if (file.size - offset - RecordHeader < header[1]) {
+                    break; // Torn record.
+                }
+                if (current >= from) {
+                    ByteReader payload(file.data + offset + RecordHeader, header[1]);
+                    auto decoder = decoders.find(header[0]);
+                    if (decoder != decoders.end() && decoder->second(payload, bus)) {
+                        ++replayed;
+                    }
+                }
+                offset += RecordHeader + header[1];
+                ++current;
+            }
+        }
+        return replayed;
+    }
+
+    // compact(): deletes snapshots older than the newest one, and segments whose
+    // events all precede it.
+    void compact() {
+        auto snapshots = files(".snap");
+        if (snapshots.empty()) {
+            return;
+        }
+        const std::uint64_t newest = snapshots.back().first;
+        for (std::size_t i = 0; i + 1 < snapshots.size(); ++i) {
+            std::filesystem::remove(snapshots[i].second);
+        }
+        auto segments = files(".seg");
+        for (std::size_t i = 0; i + 1 < segments.size(); ++i) {
+            if (segments[i + 1].first <= newest) {
+                std::filesystem::remove(segments[i].second);
+            }
+        }
+    }
+};
+
+#endif // __linux__
+
+// --- Benchmarks ---
+// Build with optimizations (e.g. g++ -std=c++17 -O3 -mavx2 -pthread) so the
+// vectorized paths are enabled. Run the tutorial normally to see the example
+// output, or pass --bench to time the optimized paths against the plain EventBus:
+//   ./event_bus --bench            (all benchmarks)
+//   ./event_bus --bench columnar   (only benchmarks whose name contains "columnar")
+
+// measureSeconds(body): wall-clock time of a single call to 'body'.
+template<typename F>
+double measureSeconds(F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Results are written here so the optimizer cannot discard the work being timed.
+volatile std::int64_t benchmarkSink = 0;
+
+// Every heap allocation in the program goes through this replacement operator new,
+// so benchmarks can report allocations per event.
+std::atomic<std::size_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Kept out of line so GCC does not pair an inlined 'new' expression with free()
+// and report a (false) mismatched-allocation warning.
+[[gnu::noinline]] void operator delete(void* memory) noexcept { std::free(memory); }
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+// benchColumnar: summing PlayerMovedEvent positions with one callback per event
+// versus one callback per batch of columns.
+void benchColumnar() {
+    const std::size_t count = 4000000;
+    std::vector<PlayerMovedEvent> events;
+    events.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        events.push_back({static_cast<int>(i % 1000), static_cast<int>(i % 777), i % 2 ? "Hero" : "Sidekick"});
+    }
+
+    std::int64_t sumX = 0, sumY = 0;
+    EventBus bus;
+    bus.setLogging(false);
+    bus.subscribe<PlayerMovedEvent>([&](const PlayerMovedEvent& event) {
+        sumX += event.x;
+        sumY += event.y;
+    });
+    double perEvent = measureSeconds([&] {
+        for (const auto& event : events) {
+            bus.emit(event);
+        }
+    });
+    benchmarkSink = sumX + sumY;
+
+    sumX = sumY = 0;
+    ColumnarChannel<PlayerMovedEvent> channel;
+    channel.subscribe([&](const ColumnarChannel<PlayerMovedEvent>::View& batch) {
+        sumPositions(batch, sumX, sumY);
+    });
+    double columnar = measureSeconds([&] {
+        for (const auto& event : events) {
+            channel.emit(event);
+        }
+        channel.flush();
+    });
+    benchmarkSink = sumX + sumY;
+
+    // The listener alone: how long the vectorized loop takes over pre-built columns.
+    EventColumns<PlayerMovedEvent> columns;
+    columns.reserve(count);
+    for (const auto& event : events) {
+        columns.append(event);
+    }
+    sumX = sumY = 0;
+    double listenerOnly = measureSeconds([&] { sumPositions(columns.view(), sumX, sumY); });
+    benchmarkSink = sumX + sumY;
+
+    std::cout << "columnar: " << count << " PlayerMovedEvents\n"
+              << "  per-event callbacks : " << perEvent * 1e9 / count << " ns/event\n"
+              << "  columnar channel    : " << columnar * 1e9 / count << " ns/event\n"
+              << "  column listener only: " << listenerOnly * 1e9 / count << " ns/event" << std::endl;
+}
+
+// benchSymbols: emitting and matching events whose name is a std::string versus a Symbol.
+// The names are longer than the small-string buffer, as real display names often are,
+// so every std::string copy allocates.
+void benchSymbols() {
+    struct StringPlayerMovedEvent {
+        int x, y;
+        std::string playerName;
+    };
+
+    const std::size_t count = 2000000;
+    const std::string names[] = {"Hero of the Northern Realm", "Goblin Warband Skirmisher",
+                                 "Wandering Merchant of Oth", "Sidekick to the Hero Himself"};
+    const Symbol symbols[] = {names[0], names[1], names[2], names[3]};
+
+    std::int64_t heroMoves = 0;
+    EventBus bus;
+    bus.setLogging(false);
+    bus.subscribe<StringPlayerMovedEvent>([&](const StringPlayerMovedEvent& event) {
+        if (event.playerName == names[0]) {
+            ++heroMoves;
+        }
+    });
+    bus.subscribe<PlayerMovedEvent>([&](const PlayerMovedEvent& event) {
+        if (event.playerName == symbols[0]) {
+            ++heroMoves;
+        }
+    });
+
+    std::size_t allocationsBefore = allocationCount.load();
+    double withStrings = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            bus.emit(StringPlayerMovedEvent{static_cast<int>(i), 0, names[i % 4]});
+        }
+    });
+    std::size_t stringAllocations = allocationCount.load() - allocationsBefore;
+
+    allocationsBefore = allocationCount.load();
+    double withSymbols = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            bus.emit(PlayerMovedEvent{static_cast<int>(i), 0, symbols[i % 4]});
+        }
+    });
+    std::size_t symbolAllocations = allocationCount.load() - allocationsBefore;
+    benchmarkSink = heroMoves;
 
-    // getTypeKey<TEvent>()
-    // This template function provides a unique address for each distinct event type TEvent.
-    // It leverages the fact that a static variable's address is unique within the program
-    // and distinct for each specialization of the template.
-    // This address serves as the key in our 'listeners' map to identify event types.
-    template<typename TEvent>
-    static void* getTypeKey() {
-        static char key; // A dummy static variable, its address is unique per TEvent type.
-        return &key;     // Return the address, which acts as our unique type identifier.
+    // Interning a name that this thread has seen before only touches its local cache.
+    std::int64_t idSum = 0;
+    double internHits = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            idSum += SymbolTable::global().intern(names[i % 4]);
+        }
+    });
+    benchmarkSink = idSum;
+
+    std::cout << "symbols: " << count << " PlayerMovedEvents\n"
+              << "  std::string names: " << withStrings * 1e9 / count << " ns/event, "
+              << static_cast<double>(stringAllocations) / count << " allocations/event\n"
+              << "  Symbol names     : " << withSymbols * 1e9 / count << " ns/event, "
+              << static_cast<double>(symbolAllocations) / count << " allocations/event\n"
+              << "  intern (cached)  : " << internHits * 1e9 / count << " ns/call" << std::endl;
+}
+
+// benchCollector: producer scaling of per-thread collection versus one shared,
+// mutex-protected queue, followed by the ordered merge on flush.
+void benchCollector() {
+    const std::size_t perThread = 100000;
+    std::cout << "collector: " << perThread << " PlayerMovedEvents per producer thread\n"
+              << "  threads   per-thread buffers   shared mutex queue   merge+emit" << std::endl;
+
+    for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+        std::int64_t received = 0;
+        EventBus bus;
+        bus.setLogging(false);
+        bus.subscribe<PlayerMovedEvent>([&](const PlayerMovedEvent& event) { received += event.x; });
+
+        EventCollector collector(bus);
+        double collectTime = measureSeconds([&] {
+            std::vector<std::thread> producers;
+            for (std::size_t t = 0; t < threads; ++t) {
+                producers.emplace_back([&collector, t, perThread] {
+                    for (std::size_t i = 0; i < perThread; ++i) {
+                        collector.collect(PlayerMovedEvent{static_cast<int>(i), static_cast<int>(t), "Hero"});
+                    }
+                });
+            }
+            for (auto& producer : producers) {
+                producer.join();
+            }
+        });
+        double mergeTime = measureSeconds([&] { collector.flush(); });
+        benchmarkSink = received;
+
+        std::mutex queueMutex;
+        std::vector<PlayerMovedEvent> sharedQueue;
+        double sharedTime = measureSeconds([&] {
+            std::vector<std::thread> producers;
+            for (std::size_t t = 0; t < threads; ++t) {
+                producers.emplace_back([&, t] {
+                    for (std::size_t i = 0; i < perThread; ++i) {
+                        std::lock_guard<std::mutex> lock(queueMutex);
+                        sharedQueue.push_back(PlayerMovedEvent{static_cast<int>(i), static_cast<int>(t), "Hero"});
+                    }
+                });
+            }
+            for (auto& producer : producers) {
+                producer.join();
+            }
+        });
+        benchmarkSink = static_cast<std::int64_t>(sharedQueue.size());
+
+        const double total = static_cast<double>(threads * perThread);
+        std::cout << "  " << threads << "\t    " << total / collectTime / 1e6 << " M/s\t\t "
+                  << total / sharedTime / 1e6 << " M/s\t\t" << mergeTime * 1e9 / total << " ns/event" << std::endl;
     }
+}
 
-public:
-    // subscribe<TEvent>(handler)
-    // Allows a component to register a callback function (handler) for a specific event type TEvent.
-    // The 'handler' function will be called whenever an event of type TEvent is emitted.
-    template<typename TEvent>
-    void subscribe(std::function<void(const TEvent&)> handler) {
-        // Get the unique key for this event type.
-        void* key = getTypeKey<TEvent>();
+// benchLifetimes: listeners that come and go (e.g. per-enemy UI widgets) while
+// events keep flowing. Dead listeners must never be called and the listener
+// list must stay bounded by the number of live subscriptions.
+void benchLifetimes() {
+    const std::size_t rounds = 200000;
+    const std::size_t liveListeners = 32;
+    const std::size_t churnPerRound = 8;
 
-        // Wrap the user's 'handler' into a std::function that accepts 'const void*'.
-        // This wrapper performs the necessary type-safe casting internally.
-        // When an event is emitted, its address (as const void*) is passed to this wrapper.
-        // The wrapper then casts it back to the expected 'const TEvent*' and calls the original 'handler'.
-        listeners[key].push_back([handler](const void* eventPtr) {
-            // Safely cast the 'const void*' back to 'const TEvent*'.
-            // We know this cast is safe because 'eventPtr' was originally a 'const TEvent*'.
-            handler(*static_cast<const TEvent*>(eventPtr));
+    std::int64_t calls = 0;
+    EventBus bus;
+    bus.setLogging(false);
+    std::vector<ListenerToken> live;
+    for (std::size_t i = 0; i < liveListeners; ++i) {
+        live.push_back(bus.subscribeScoped<PlayerMovedEvent>([&](const PlayerMovedEvent&) { ++calls; }));
+    }
+
+    std::size_t peakListeners = 0;
+    std::size_t deadCalls = 0;
+    double elapsed = measureSeconds([&] {
+        for (std::size_t round = 0; round < rounds; ++round) {
+            // Short-lived listeners: their tokens die at the end of this block.
+            std::vector<ListenerToken> shortLived;
+            for (std::size_t i = 0; i < churnPerRound; ++i) {
+                shortLived.push_back(bus.subscribeScoped<PlayerMovedEvent>(
+                    [&](const PlayerMovedEvent&) { ++calls; }));
+            }
+            peakListeners = std::max(peakListeners, bus.listenerCount<PlayerMovedEvent>());
+            shortLived.clear();
+            // Every listener called now must be one of the long-lived ones.
+            std::int64_t before = calls;
+            bus.emit(PlayerMovedEvent{static_cast<int>(round), 0, "Hero"});
+            deadCalls += static_cast<std::size_t>(calls - before) - liveListeners;
+        }
+    });
+    benchmarkSink = calls;
+
+    std::cout << "lifetimes: " << rounds << " rounds of " << churnPerRound << " short-lived + "
+              << liveListeners << " live listeners\n"
+              << "  " << elapsed * 1e9 / rounds << " ns/round (subscribe churn + emit)\n"
+              << "  peak listener slots: " << peakListeners << ", after churn: "
+              << bus.listenerCount<PlayerMovedEvent>() << ", dead handler calls: " << deadCalls << std::endl;
+}
+
+// benchSampling: an expensive telemetry listener throttled by each DeliveryPolicy.
+void benchSampling() {
+    const std::size_t count = 2000000;
+    struct Case {
+        const char* name;
+        DeliveryPolicy policy;
+    };
+    const Case cases[] = {
+        {"every()          ", DeliveryPolicy::every()},
+        {"everyNth(100)    ", DeliveryPolicy::everyNth(100)},
+        {"maxPerSecond(1000)", DeliveryPolicy::maxPerSecond(1000)},
+        {"reservoir(1000)  ", DeliveryPolicy::reservoir(1000)},
+    };
+
+    std::cout << "sampling: " << count << " PlayerMovedEvents into a ~100 ns telemetry listener" << std::endl;
+    for (const auto& c : cases) {
+        std::size_t delivered = 0;
+        EventBus bus;
+        bus.setLogging(false);
+        bus.subscribe<PlayerMovedEvent>([&](const PlayerMovedEvent& event) {
+            // Stand-in for real telemetry work (formatting, hashing, buffering).
+            std::uint64_t hash = static_cast<std::uint64_t>(event.x);
+            for (int round = 0; round < 64; ++round) {
+                hash = hash * 6364136223846793005ull + 1442695040888963407ull;
+            }
+            benchmarkSink = static_cast<std::int64_t>(hash);
+            ++delivered;
+        }, c.policy);
+        double elapsed = measureSeconds([&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                bus.emit(PlayerMovedEvent{static_cast<int>(i), 0, "Hero"});
+            }
+        });
+        std::cout << "  " << c.name << ": " << elapsed * 1e9 / count << " ns/emit, "
+                  << delivered << " delivered" << std::endl;
+    }
+}
+
+// benchTimers: a million pending scheduled emits in the timing wheel.
+void benchTimers() {
+    const std::size_t count = 1000000;
+    std::int64_t fired = 0;
+    EventBus bus;
+    bus.setLogging(false);
+    bus.subscribe<EnemySpawnedEvent>([&](const EnemySpawnedEvent&) { ++fired; });
+
+    std::vector<TimerId> ids(count);
+    std::uint64_t random = 88172645463325252ull;
+    const auto start = EventBus::Clock::now();
+    double scheduleTime = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            // Delays spread over 2^26 ms (about 18.6 hours), so every wheel level is
+            // exercised: level 3 holds the deadlines beyond 2^24 ms (about 4.7 hours).
+            auto delay = std::chrono::milliseconds(1 + random % (std::uint64_t(1) << 26));
+            ids[i] = bus.emitAt(start + delay, EnemySpawnedEvent{static_cast<int>(i), 100.0f, "Goblin"});
+        }
+    });
+    const std::size_t pendingAfterSchedule = bus.pendingTimers();
+
+    double cancelTime = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; i += 2) {
+            bus.cancelTimer(ids[i]);
+        }
+    });
+
+    double advanceTime = measureSeconds([&] { bus.advanceTimers(start + std::chrono::hours(19)); });
+    benchmarkSink = fired;
+
+    std::cout << "timers: " << pendingAfterSchedule << " pending scheduled emits\n"
+              << "  emitAt     : " << scheduleTime * 1e9 / count << " ns/timer\n"
+              << "  cancelTimer: " << cancelTime * 1e9 / (count / 2) << " ns/timer\n"
+              << "  advance 19 simulated hours: " << advanceTime * 1e3 << " ms, " << fired
+              << " fired (" << advanceTime * 1e9 / static_cast<double>(std::max<std::int64_t>(fired, 1))
+              << " ns/fired emit)" << std::endl;
+}
+
+// benchPool: pooled event copies versus std::make_shared, on one thread and with
+// copies made on a producer thread and released on the dispatching thread.
+void benchPool() {
+    // Large enough that EventCollector cannot store it inline.
+    struct WorldSnapshotEvent {
+        double positions[16];
+        int frame;
+    };
+    const std::size_t count = 2000000;
+    const WorldSnapshotEvent snapshot{{1.0, 2.0, 3.0}, 7};
+
+    double pooled = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto ref = EventPool<WorldSnapshotEvent>::instance().acquire(snapshot);
+            benchmarkSink = ref->frame;
+        }
+    });
+    double shared = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto copy = std::make_shared<WorldSnapshotEvent>(snapshot);
+            benchmarkSink = copy->frame;
+        }
+    });
+
+    // Cross-thread: a producer collects while this thread flushes and releases.
+    std::int64_t received = 0;
+    EventBus bus;
+    bus.setLogging(false);
+    bus.subscribe<WorldSnapshotEvent>([&](const WorldSnapshotEvent& event) { received += event.frame; });
+    EventCollector collector(bus);
+    std::atomic<bool> done{false};
+    double crossThread = measureSeconds([&] {
+        std::thread producer([&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                collector.collect(snapshot);
+            }
+            done.store(true);
+        });
+        while (!done.load()) {
+            collector.flush();
+        }
+        producer.join();
+        collector.flush();
+    });
+    benchmarkSink = received;
+
+    auto stats = EventPool<WorldSnapshotEvent>::instance().stats();
+    std::cout << "pool: " << count << " copies of a " << sizeof(WorldSnapshotEvent) << "-byte event\n"
+              << "  same thread, pooled     : " << pooled * 1e9 / count << " ns/copy\n"
+              << "  same thread, make_shared: " << shared * 1e9 / count << " ns/copy\n"
+              << "  collect on producer, release on dispatcher: " << crossThread * 1e9 / count << " ns/event\n"
+              << "  pool hit rate " << stats.hitRate() * 100.0 << "%, " << stats.remoteReturns
+              << " cross-thread returns, peak footprint " << stats.capacity << " slots ("
+              << stats.footprintBytes / 1024 << " KiB)" << std::endl;
+}
+
+// benchQueries: asking "which enemies are within range?" three ways.
+void benchQueries() {
+    // The emit-based pattern: a request event carrying a correlation ID, and a
+    // reply event the requester matches back to its pending request.
+    struct RangeRequestEvent {
+        std::uint64_t correlationID;
+        EnemiesInRangeQuery query;
+    };
+    struct RangeReplyEvent {
+        std::uint64_t correlationID;
+        EnemiesInRangeResult result;
+    };
+
+    const std::size_t count = 1000000;
+    auto answer = [](const EnemiesInRangeQuery& query) {
+        return EnemiesInRangeResult{query.x & 7, query.y};
+    };
+
+    EventBus bus;
+    bus.setLogging(false);
+    bus.respond<EnemiesInRangeQuery, EnemiesInRangeResult>(answer);
+    bus.subscribe<RangeRequestEvent>([&](const RangeRequestEvent& request) {
+        bus.emit(RangeReplyEvent{request.correlationID, answer(request.query)});
+    });
+    std::unordered_map<std::uint64_t, EnemiesInRangeResult> pendingReplies;
+    bus.subscribe<RangeReplyEvent>([&](const RangeReplyEvent& reply) {
+        pendingReplies[reply.correlationID] = reply.result;
+    });
+
+    std::int64_t total = 0;
+    std::size_t allocationsBefore = allocationCount.load();
+    double viaEvents = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            bus.emit(RangeRequestEvent{i, {static_cast<int>(i), 0, 10}});
+            auto reply = pendingReplies.find(i);
+            total += reply->second.count;
+            pendingReplies.erase(reply);
+        }
+    });
+    std::size_t eventAllocations = allocationCount.load() - allocationsBefore;
+
+    allocationsBefore = allocationCount.load();
+    double direct = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            total += bus.query<EnemiesInRangeQuery, EnemiesInRangeResult>({static_cast<int>(i), 0, 10}).count;
+        }
+    });
+    std::size_t directAllocations = allocationCount.load() - allocationsBefore;
+
+    allocationsBefore = allocationCount.load();
+    double async = measureSeconds([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto future = bus.queryAsync<EnemiesInRangeQuery, EnemiesInRangeResult>({static_cast<int>(i), 0, 10});
+            bus.processQueries();
+            total += future.get().count;
+        }
+    });
+    std::size_t asyncAllocations = allocationCount.load() - allocationsBefore;
+    benchmarkSink = total;
+
+    std::cout << "queries: " << count << " range queries\n"
+              << "  request/reply events: " << viaEvents * 1e9 / count << " ns/query, "
+              << static_cast<double>(eventAllocations) / count << " allocations/query\n"
+              << "  query               : " << direct * 1e9 / count << " ns/query, "
+              << static_cast<double>(directAllocations) / count << " allocations/query\n"
+              << "  queryAsync          : " << async * 1e9 / count << " ns/query, "
+              << static_cast<double>(asyncAllocations) / count << " allocations/query" << std::endl;
+}
+
+// benchMailbox: several threads emitting into a listener whose state is a small
+// table of counters. Dispatched on the emitting threads, the table needs atomics
+// and its cache lines bounce between cores; delivered through a mailbox, only the
+// consumer thread ever touches it. (Use 'perf stat -e cache-misses' around this
+// benchmark to see the coherence traffic directly.)
+void benchMailbox() {
+    const unsigned cores = std::thread::hardware_concurrency(); // 0 if unknown.
+    const std::size_t emitters = std::max(2u, cores > 1 ? cores - 1 : 1);
+    const std::size_t perEmitter = 500000;
+    const std::size_t total = emitters * perEmitter;
+
+    auto runEmitters = [&](const std::function<void(EventBus&)>& subscribe) {
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < emitters; ++t) {
+            threads.emplace_back([&, t] {
+                EventBus bus; // One bus per emitting thread, all feeding the same listener state.
+                bus.setLogging(false);
+                subscribe(bus);
+                for (std::size_t i = 0; i < perEmitter; ++i) {
+                    bus.emit(PlayerMovedEvent{static_cast<int>(i + t), 0, "Hero"});
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    std::atomic<std::uint64_t> sharedCounts[64] = {};
+    double direct = measureSeconds([&] {
+        runEmitters([&](EventBus& bus) {
+            bus.subscribe<PlayerMovedEvent>([&](const PlayerMovedEvent& event) {
+                sharedCounts[event.x & 63].fetch_add(1, std::memory_order_relaxed);
+            });
+        });
+    });
+
+    std::uint64_t ownedCounts[64] = {};
+    std::size_t handled = 0;
+    Mailbox mailbox(1 << 16);
+    double viaMailbox = measureSeconds([&] {
+        std::thread consumer([&] {
+            while (handled < total) {
+                std::size_t ran = mailbox.drain(1024);
+                handled += ran;
+                if (ran == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        runEmitters([&](EventBus& bus) {
+            bus.subscribe<PlayerMovedEvent>(mailbox, [&](const PlayerMovedEvent& event) { ++ownedCounts[event.x & 63]; });
+        });
+        consumer.join();
+    });
+    benchmarkSink = static_cast<std::int64_t>(sharedCounts[0].load() + ownedCounts[0]);
+
+    std::cout << "mailbox: " << emitters << " emitting threads x " << perEmitter << " PlayerMovedEvents\n"
+              << "  dispatch on emitting threads (atomic state): " << direct * 1e9 / total << " ns/event\n"
+              << "  delivered to consumer's mailbox (owned state): " << viaMailbox * 1e9 / total << " ns/event"
+              << std::endl;
+}
+
+// benchBackpressure: a fast producer feeding a slow mailbox consumer under each
+// overflow policy, with a window of 256 credits.
+void benchBackpressure() {
+    const std::size_t count = 200000;
+    struct Case {
+        const char* name;
+        Backpressure backpressure;
+    };
+    const Case cases[] = {
+        {"shed(256)    ", Backpressure::shed(256)},
+        {"coalesce(256)", Backpressure::coalesce(256)},
+        {"block(256)   ", Backpressure::block(256)},
+    };
+
+    std::cout << "backpressure: " << count << " PlayerMovedEvents into a ~1 us/event consumer" << std::endl;
+    for (const auto& c : cases) {
+        EventBus bus;
+        bus.setLogging(false);
+        Mailbox mailbox(1 << 12);
+        bus.subscribe<PlayerMovedEvent>(mailbox, [](const PlayerMovedEvent& event) {
+            // Stand-in for slow work such as UI layout.
+            auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(1);
+            while (std::chrono::steady_clock::now() < until) {
+            }
+            benchmarkSink = event.x;
+        }, DeliveryPolicy::every(), c.backpressure);
+
+        std::atomic<bool> producing{true};
+        std::thread consumer([&] {
+            while (producing.load() || mailbox.pending() != 0) {
+                if (mailbox.drain(64) == 0) {
+                    std::this_thread::yield();
+                }
+            }
         });
+        std::size_t saturatedEmits = 0;
+        double produce = measureSeconds([&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (bus.emit(PlayerMovedEvent{static_cast<int>(i), 0, "Hero"}).saturated()) {
+                    ++saturatedEmits;
+                }
+            }
+        });
+        producing.store(false);
+        consumer.join();
 
-        std::cout << "Subscribed to event type: " << typeid(TEvent).name() << std::endl;
+        auto stats = mailbox.stats().front();
+        std::cout << "  " << c.name << ": producer " << produce * 1e9 / count << " ns/emit, "
+                  << saturatedEmits << " saturated emits; delivered " << stats.delivered << ", shed "
+                  << stats.shed << ", coalesced " << stats.coalesced << ", blocked " << stats.blocked
+                  << ", peak depth " << stats.peakDepth << std::endl;
     }
+}
 
-    // emit<TEvent>(event)
-    // Publishes an event of type TEvent to all registered listeners.
-    // The EventBus iterates through all handlers subscribed to TEvent and invokes them,
-    // passing a constant reference to the 'event' object.
-    template<typename TEvent>
-    void emit(const TEvent& event) {
-        // Get the unique key for this event type.
-        void* key = getTypeKey<TEvent>();
+// benchTracing: what stamping costs on the direct path, then the latency it
+// reports for collected events and for events queued to a mailbox. The spans are
+// written as a Chrome trace (open it in chrome://tracing or Perfetto).
+void benchTracing() {
+    const std::size_t count = 1000000;
+    EventTracer& tracer = EventTracer::instance();
+    EventBus bus;
+    bus.setLogging(false);
+    bus.subscribe<PlayerMovedEvent>([](const PlayerMovedEvent& event) { benchmarkSink = event.x; });
 
-        // Check if there are any listeners registered for this specific event type.
-        auto it = listeners.find(key);
-        if (it != listeners.end()) {
-            std::cout << "Emitting event: " << typeid(TEvent).name() << std::endl;
-            // Iterate over all handlers registered for TEvent.
-            // Pass the address of the 'event' object as 'const void*' to each handler.
-            for (auto& handler : it->second) {
-                handler(static_cast<const void*>(&event));
+    auto emitAll = [&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            bus.emit(PlayerMovedEvent{static_cast<int>(i), 0, "Hero"});
+        }
+    };
+    double untraced = measureSeconds(emitAll);
+    tracer.enable(1 << 16);
+    double traced = measureSeconds(emitAll);
+
+    // Collected events wait in the collector until the flush.
+    EventBus enemies;
+    enemies.setLogging(false);
+    enemies.subscribe<EnemySpawnedEvent>([](const EnemySpawnedEvent& event) { benchmarkSink = event.enemyID; });
+    EventCollector collector(enemies);
+    for (int i = 0; i < 10000; ++i) {
+        collector.collect(EnemySpawnedEvent{i, 100.0f, "Goblin"});
+    }
+    collector.flush();
+
+    // Mailbox deliveries wait for the consumer thread.
+    EventBus states;
+    states.setLogging(false);
+    Mailbox mailbox(1 << 12);
+    states.subscribe<GameStateChangedEvent>(mailbox, [](const GameStateChangedEvent& event) {
+        benchmarkSink = static_cast<std::int64_t>(event.newState.size());
+    });
+    std::atomic<bool> producing{true};
+    std::thread consumer([&] {
+        while (producing.load() || mailbox.pending() != 0) {
+            if (mailbox.drain(64) == 0) {
+                std::this_thread::yield();
             }
-        } else {
-            std::cout << "No listeners for event type: " << typeid(TEvent).name() << std::endl;
         }
+    });
+    for (int i = 0; i < 10000; ++i) {
+        states.emit(GameStateChangedEvent{"Playing"});
+    }
+    producing.store(false);
+    consumer.join();
+    tracer.disable();
+
+    std::cout << "tracing: " << count << " direct emits\n"
+              << "  tracing off: " << untraced * 1e9 / count << " ns/emit\n"
+              << "  tracing on : " << traced * 1e9 / count << " ns/emit" << std::endl;
+    tracer.printSummary(std::cout);
+    std::string path = (std::filesystem::temp_directory_path() / "event_bus_trace.json").string();
+    if (tracer.writeChromeTrace(path)) {
+        std::cout << "  trace written to " << path << std::endl;
     }
+}
 
-    // unsubscribe<TEvent>(...) - Optional, not implemented to keep tutorial focused and brief.
-    // Implementing unsubscribe would require storing a unique identifier for each subscription
-    // (e.g., a shared_ptr, or a token returned by subscribe) to allow removal of specific handlers.
+// PaddedInner/PaddedOuter: raw fields around padding, nested. Only the fields are
+// encoded (1 + 4 + 1 bytes), never the padding; benchSerialization checks this.
+struct PaddedInner {
+    char a;
+    int b;
+};
+EVENT_FIELDS(PaddedInner, a, b);
+struct PaddedOuter {
+    PaddedInner inner;
+    char c;
 };
+EVENT_FIELDS(PaddedOuter, inner, c);
 
-// --- Example Event Structures ---
-// Define simple struct to represent different types of events.
-// Events are plain data structures that carry information.
+// benchSerialization: encode and decode throughput for a field-by-field event
+// (PlayerMovedEvent, whose Symbol travels as text) and a memcpy-able one
+// (EnemiesInRangeQuery), batched into one buffer.
+void benchSerialization() {
+    const std::size_t count = 1000000;
+    auto report = [](const char* name, std::size_t bytes, double encode, double decode) {
+        std::cout << "  " << name << ": " << bytes / count << " bytes/event, encode "
+                  << bytes / encode / 1e9 << " GB/s, decode " << bytes / decode / 1e9 << " GB/s" << std::endl;
+    };
+    std::cout << "serialization: " << count << " events per type" << std::endl;
 
-struct PlayerMovedEvent {
-    int x, y;
-    std::string playerName;
+    const Symbol names[] = {"Hero", "Sidekick", "Rogue", "Wizard"};
+    std::vector<PlayerMovedEvent> moves(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        moves[i] = PlayerMovedEvent{static_cast<int>(i), static_cast<int>(i * 3), names[i & 3]};
+    }
+    std::vector<char> buffer;
+    buffer.reserve(count * 32);
+    double encode = measureSeconds([&] { serialize(buffer, moves.data(), moves.size()); });
+    std::vector<PlayerMovedEvent> movesBack(count);
+    double decode = measureSeconds([&] {
+        ByteReader in(buffer.data(), buffer.size());
+        deserialize(in, movesBack.data(), movesBack.size());
+    });
+    if (movesBack.back().x != moves.back().x || movesBack.back().playerName != moves.back().playerName) {
+        std::cout << "  PlayerMovedEvent round trip FAILED" << std::endl;
+    }
+    report("PlayerMovedEvent   ", buffer.size(), encode, decode);
+
+    std::vector<EnemiesInRangeQuery> queries(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        queries[i] = EnemiesInRangeQuery{static_cast<int>(i), static_cast<int>(i + 1), 30};
+    }
+    buffer.clear();
+    encode = measureSeconds([&] { serialize(buffer, queries.data(), queries.size()); });
+    std::vector<EnemiesInRangeQuery> queriesBack(count);
+    decode = measureSeconds([&] {
+        ByteReader in(buffer.data(), buffer.size());
+        deserialize(in, queriesBack.data(), queriesBack.size());
+    });
+    if (queriesBack.back().y != queries.back().y) {
+        std::cout << "  EnemiesInRangeQuery round trip FAILED" << std::endl;
+    }
+    report("EnemiesInRangeQuery", buffer.size(), encode, decode);
+
+    const PaddedOuter padded{{'a', 42}, 'c'};
+    buffer.clear();
+    serialize(buffer, padded);
+    PaddedOuter paddedBack{};
+    ByteReader paddedIn(buffer.data(), buffer.size());
+    if (buffer.size() != 6 || EventCodec<PaddedOuter>::size(padded) != 6 ||
+        !EventCodec<PaddedOuter>::read(paddedIn, paddedBack) || paddedIn.remaining() != 0 ||
+        paddedBack.inner.a != 'a' || paddedBack.inner.b != 42 || paddedBack.c != 'c') {
+        std::cout << "  PaddedOuter (nested padding) round trip FAILED" << std::endl;
+    }
+    benchmarkSink = movesBack[count / 2].y + queriesBack[count / 2].x;
+}
+
+#if defined(__linux__)
+// benchBridge: a sender and a receiver in the same process, on separate threads,
+// over a Unix domain socket and over loopback TCP. Throughput streams a burst of
+// PlayerMovedEvents; latency times one flushed event until the receiving bus has
+// emitted it.
+void benchBridge() {
+    const std::size_t count = 1000000;
+    const std::size_t pings = 2000;
+    const std::string path = (std::filesystem::temp_directory_path() / "event_bus_bridge.sock").string();
+
+    for (bool tcp : {false, true}) {
+        EventBus remote;
+        remote.setLogging(false);
+        std::atomic<std::size_t> arrived{0};
+        remote.subscribe<PlayerMovedEvent>([&](const PlayerMovedEvent&) {
+            arrived.store(arrived.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        });
+        auto receiver = tcp ? EventBridgeReceiver::listenTcp(remote) : EventBridgeReceiver::listenUnix(remote, path);
+        receiver->accept<PlayerMovedEvent>();
+        std::atomic<bool> running{true};
+        std::thread receiving([&] {
+            while (running.load()) {
+                receiver->poll(1);
+            }
+        });
+
+        EventBus local;
+        local.setLogging(false);
+        auto sender = tcp ? EventBridgeSender::connectTcp(receiver->port()) : EventBridgeSender::connectUnix(path);
+        sender->forward<PlayerMovedEvent>(local);
+
+        double stream = measureSeconds([&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                local.emit(PlayerMovedEvent{static_cast<int>(i), 0, "Hero"});
+            }
+            sender->flush();
+            while (arrived.load(std::memory_order_acquire) < count) {
+                std::this_thread::yield();
+            }
+        });
+
+        std::vector<double> latencies;
+        for (std::size_t i = 0; i < pings; ++i) {
+            const std::size_t target = arrived.load() + 1;
+            latencies.push_back(measureSeconds([&] {
+                local.emit(PlayerMovedEvent{0, 0, "Hero"});
+                sender->flush();
+                while (arrived.load(std::memory_order_acquire) < target) {
+                    std::this_thread::yield();
+                }
+            }));
+        }
+        running.store(false);
+        receiving.join();
+        std::sort(latencies.begin(), latencies.end());
+
+        std::cout << "bridge (" << (tcp ? "loopback TCP" : "Unix socket") << "): " << count / stream / 1e6
+                  << " M events/s streamed; one-event latency p50 " << latencies[pings / 2] * 1e6 << " us, p99 "
+                  << latencies[pings * 99 / 100] * 1e6 << " us" << std::endl;
+    }
+}
+#endif
+
+#if defined(__linux__)
+// PlayerPositions: listener-owned state rebuilt from the journal in benchJournal.
+struct PlayerPositions {
+    std::vector<int> x, y; // Last position per player slot.
+    std::uint64_t moves = 0;
 };
+EVENT_FIELDS(PlayerPositions, x, y, moves);
 
-struct EnemySpawnedEvent {
-    int enemyID;
-    float health;
-    std::string type;
+// benchJournal: startup time of a journaled PlayerPositions, replaying the whole
+// log versus loading the newest snapshot and replaying the tail after it.
+void benchJournal() {
+    const std::size_t slots = 1024;
+    const std::uint64_t snapshotPeriod = 65536;
+    const auto root = std::filesystem::temp_directory_path() / "event_bus_journal_bench";
+
+    std::cout << "journal: startup with and without snapshots (one every " << snapshotPeriod << " events)" << std::endl;
+    for (std::size_t count : {100000u, 1000000u, 4000000u}) {
+        std::filesystem::remove_all(root);
+        auto track = [&](EventBus& bus, PlayerPositions& state) {
+            bus.subscribe<PlayerMovedEvent>([&state, slots](const PlayerMovedEvent& event) {
+                state.x[event.x & (slots - 1)] = event.x;
+                state.y[event.x & (slots - 1)] = event.y;
+                ++state.moves;
+            });
+        };
+        auto fresh = [&] {
+            PlayerPositions state;
+            state.x.assign(slots, 0);
+            state.y.assign(slots, 0);
+            return state;
+        };
+
+        // Write the same stream to a plain journal and to one with snapshots.
+        double writeSeconds = 0;
+        for (bool withSnapshots : {false, true}) {
+            EventBus bus;
+            bus.setLogging(false);
+            PlayerPositions state = fresh();
+            track(bus, state);
+            EventJournal journal(root / (withSnapshots ? "snapshots" : "plain"));
+            journal.record<PlayerMovedEvent>(bus);
+            if (withSnapshots) {
+                journal.snapshotEvery(snapshotPeriod, state);
+            }
+            double seconds = measureSeconds([&] {
+                for (std::size_t i = 0; i < count; ++i) {
+                    bus.emit(PlayerMovedEvent{static_cast<int>(i), static_cast<int>(i / slots), "Hero"});
+                }
+                journal.flush();
+            });
+            if (!withSnapshots) {
+                writeSeconds = seconds;
+            }
+        }
+
+        double startup[2] = {};
+        std::uint64_t replayed[2] = {};
+        std::uint64_t moves[2] = {};
+        for (int withSnapshots : {0, 1}) {
+            startup[withSnapshots] = measureSeconds([&] {
+                EventBus bus;
+                bus.setLogging(false);
+                PlayerPositions state = fresh();
+                EventJournal journal(root / (withSnapshots ? "snapshots" : "plain"));
+                journal.replay<PlayerMovedEvent>();
+                track(bus, state);
+                replayed[withSnapshots] = journal.restore(state, bus);
+                moves[withSnapshots] = state.moves;
+            });
+        }
+        if (moves[0] != count || moves[1] != count) {
+            std::cout << "  state mismatch after restore!" << std::endl;
+        }
+        std::uint64_t bytes = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(root / "plain")) {
+            bytes += entry.file_size();
+        }
+        std::cout << "  " << count << " events (" << bytes / (1 << 20) << " MB, written at "
+                  << count / writeSeconds / 1e6 << " M events/s): full replay " << startup[0] * 1e3
+                  << " ms; snapshot + " << replayed[1] << "-event tail " << startup[1] * 1e3 << " ms" << std::endl;
+    }
+    std::filesystem::remove_all(root);
+}
+#endif
+
+// benchChannels: 100k channels (room/<n>/<kind>) with a per-room listener on
+// 10k rooms plus two wildcard listeners. The baseline is what the same listeners
+// cost on a plain EventBus, where each of them filters out other rooms' events.
+void benchChannels() {
+    const std::size_t rooms = 33334;
+    const char* kinds[] = {"player", "enemy", "loot"};
+    const std::size_t roomListeners = 10000;
+    std::uint64_t delivered = 0;
+
+    ChannelBus channels;
+    std::vector<Channel> handles;
+    double registerSeconds = measureSeconds([&] {
+        for (std::size_t room = 0; room < rooms; ++room) {
+            for (const char* kind : kinds) {
+                handles.push_back(channels.channel("room/" + std::to_string(room) + "/" + kind));
+            }
+        }
+    });
+    for (std::size_t room = 0; room < roomListeners; ++room) {
+        channels.subscribe<PlayerMovedEvent>("room/" + std::to_string(room) + "/player",
+                                             [&](const PlayerMovedEvent&) { ++delivered; });
+    }
+    channels.subscribe<PlayerMovedEvent>("room/*/player", [&](const PlayerMovedEvent&) { ++delivered; });
+    channels.subscribe<PlayerMovedEvent>("room/#", [&](const PlayerMovedEvent&) { ++delivered; });
+    double compileSeconds = measureSeconds([&] { channels.emit(handles[0], PlayerMovedEvent{0, 0, "Hero"}); });
+
+    // Emit to channels in a scattered order, as game traffic would.
+    const std::size_t count = 1000000;
+    std::vector<std::uint32_t> order(count);
+    std::uint64_t random = 0x9E3779B97F4A7C15ull;
+    for (auto& index : order) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        index = static_cast<std::uint32_t>(random % handles.size());
+    }
+    double routed = measureSeconds([&] {
+        for (std::uint32_t index : order) {
+            channels.emit(handles[index], PlayerMovedEvent{static_cast<int>(index), 0, "Hero"});
+        }
+    });
+
+    EventBus bus;
+    bus.setLogging(false);
+    for (std::size_t room = 0; room < roomListeners; ++room) {
+        const int playerChannel = static_cast<int>(room * 3); // handles[] index of room/<room>/player
+        bus.subscribe<PlayerMovedEvent>([&, playerChannel](const PlayerMovedEvent& event) {
+            if (event.x == playerChannel) {
+                ++delivered;
+            }
+        });
+    }
+    const std::size_t baselineCount = 2000;
+    double filtered = measureSeconds([&] {
+        for (std::size_t i = 0; i < baselineCount; ++i) {
+            bus.emit(PlayerMovedEvent{static_cast<int>(order[i]), 0, "Hero"});
+        }
+    });
+    benchmarkSink = static_cast<std::int64_t>(delivered);
+
+    std::cout << "channels: " << handles.size() << " channels, " << roomListeners + 2 << " subscriptions\n"
+              << "  register channels: " << registerSeconds * 1e9 / handles.size() << " ns/channel; compile: "
+              << compileSeconds * 1e3 << " ms\n"
+              << "  ChannelBus emit (compiled table): " << routed * 1e9 / count << " ns/emit\n"
+              << "  EventBus emit, listeners filter : " << filtered * 1e9 / baselineCount << " ns/emit" << std::endl;
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
 };
 
-struct GameStateChangedEvent {
-    std::string newState;
+const Benchmark benchmarks[] = {
+    {"columnar", benchColumnar},
+    {"symbols", benchSymbols},
+    {"collector", benchCollector},
+    {"lifetimes", benchLifetimes},
+    {"sampling", benchSampling},
+    {"timers", benchTimers},
+    {"pool", benchPool},
+    {"queries", benchQueries},
+    {"mailbox", benchMailbox},
+    {"backpressure", benchBackpressure},
+    {"tracing", benchTracing},
+    {"serialization", benchSerialization},
+    {"channels", benchChannels},
+#if defined(__linux__)
+    {"bridge", benchBridge},
+    {"journal", benchJournal},
+#endif
 };
 
+int runBenchmarks(const std::string& filter) {
+    for (const auto& benchmark : benchmarks) {
+        if (filter.empty() || std::string(benchmark.name).find(filter) != std::string::npos) {
+            benchmark.run();
+        }
+    }
+    return 0;
+}
+
 // --- Main function with example usage ---
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return runBenchmarks(argc > 2 ? argv[2] : "");
+    }
+
     std::cout << "--- Event Bus Tutorial Example ---" << std::endl << std::endl;
 
     // Create an instance of our EventBus.
@@ -176,6 +4796,282 @@ int main() {
     NonExistentEvent noListenersEvent;
     gameEventBus.emit(noListenersEvent);
 
+    std::cout << std::endl;
+
+    // --- Columnar Channel Example ---
+    // Analytics listeners receive whole batches as column arrays instead of single events.
+    std::cout << "--- Columnar Channel ---" << std::endl;
+    ColumnarChannel<PlayerMovedEvent> movementAnalytics;
+    movementAnalytics.subscribe([&](const ColumnarChannel<PlayerMovedEvent>::View& batch) {
+        std::int64_t sumX = 0, sumY = 0;
+        sumPositions(batch, sumX, sumY);
+        std::cout << "[Analytics] " << batch.size << " moves, average position ("
+                  << sumX / static_cast<std::int64_t>(batch.size) << ", "
+                  << sumY / static_cast<std::int64_t>(batch.size) << ")" << std::endl;
+    });
+    movementAnalytics.emit(playerMove1);
+    movementAnalytics.emit(playerMove2);
+    movementAnalytics.flush(); // Deliver the partial batch.
+
+    std::cout << std::endl;
+
+    // --- Per-Thread Collection Example ---
+    // Worker threads collect events without locking; the main thread flushes them
+    // into the bus in the order they were produced.
+    std::cout << "--- Per-Thread Collection ---" << std::endl;
+    EventCollector collector(gameEventBus);
+    std::thread spawner([&collector] { collector.collect(EnemySpawnedEvent{102, 80.0f, "Orc"}); });
+    spawner.join();
+    std::thread mover([&collector] { collector.collect(PlayerMovedEvent{30, 40, "Hero"}); });
+    mover.join();
+    std::size_t flushed = collector.flush();
+    std::cout << "Flushed " << flushed << " collected events." << std::endl;
+
+    std::cout << std::endl;
+
+    // --- Lifetime-Bound Listener Example ---
+    // The HUD's listener captures a raw pointer to the HUD. Binding the subscription
+    // to the HUD's shared_ptr guarantees the listener dies with the HUD.
+    std::cout << "--- Lifetime-Bound Listeners ---" << std::endl;
+    struct Hud {
+        int enemiesSeen = 0;
+    };
+    auto hud = std::make_shared<Hud>();
+    gameEventBus.subscribe<EnemySpawnedEvent>(hud, [raw = hud.get()](const EnemySpawnedEvent&) {
+        ++raw->enemiesSeen;
+        std::cout << "[HUD] Enemies seen: " << raw->enemiesSeen << std::endl;
+    });
+    gameEventBus.emit(EnemySpawnedEvent{103, 30.0f, "Goblin"});
+    hud.reset(); // The HUD is destroyed; its listener must not run again.
+    gameEventBus.emit(EnemySpawnedEvent{104, 30.0f, "Goblin"});
+    std::cout << "EnemySpawnedEvent listeners after compaction: "
+              << gameEventBus.listenerCount<EnemySpawnedEvent>() << std::endl;
+
+    std::cout << std::endl;
+
+    // --- Delivery Policy Example ---
+    // The minimap only needs every third position update.
+    std::cout << "--- Delivery Policies ---" << std::endl;
+    EventBus minimapBus;
+    minimapBus.setLogging(false);
+    minimapBus.subscribe<PlayerMovedEvent>([](const PlayerMovedEvent& event) {
+        std::cout << "[Minimap] " << event.playerName << " at (" << event.x << ", " << event.y << ")" << std::endl;
+    }, DeliveryPolicy::everyNth(3));
+    for (int step = 0; step < 6; ++step) {
+        minimapBus.emit(PlayerMovedEvent{step, step, "Scout"});
+    }
+
+    std::cout << std::endl;
+
+    // --- Scheduled Emit Example ---
+    // The main loop advances the bus's timers once per frame; here we step time by hand.
+    std::cout << "--- Scheduled Emits ---" << std::endl;
+    EventBus scheduledBus;
+    scheduledBus.setLogging(false);
+    scheduledBus.subscribe<EnemySpawnedEvent>([](const EnemySpawnedEvent& event) {
+        std::cout << "[Spawner] Enemy " << event.enemyID << " (" << event.type << ") arrives." << std::endl;
+    });
+    scheduledBus.subscribe<GameStateChangedEvent>([](const GameStateChangedEvent& event) {
+        std::cout << "[Clock] " << event.newState << std::endl;
+    });
+    const auto frameStart = EventBus::Clock::now();
+    scheduledBus.emitAt(frameStart + std::chrono::milliseconds(500), EnemySpawnedEvent{105, 60.0f, "Troll"});
+    TimerId heartbeat = scheduledBus.emitEvery(std::chrono::milliseconds(200), GameStateChangedEvent{"Heartbeat"});
+    for (int frame = 1; frame <= 5; ++frame) {
+        scheduledBus.advanceTimers(frameStart + std::chrono::milliseconds(150 * frame));
+    }
+    scheduledBus.cancelTimer(heartbeat);
+    std::cout << "Pending timers after cancelling the heartbeat: " << scheduledBus.pendingTimers() << std::endl;
+
+    std::cout << std::endl;
+
+    // --- Query Example ---
+    // The enemy manager answers range queries; callers get the answer directly.
+    std::cout << "--- Queries ---" << std::endl;
+    struct EnemyPosition {
+        int enemyID, x, y;
+    };
+    const std::vector<EnemyPosition> enemies = {{101, 12, 22}, {102, 40, 40}, {103, 90, 10}};
+    gameEventBus.respond<EnemiesInRangeQuery, EnemiesInRangeResult>([&enemies](const EnemiesInRangeQuery& query) {
+        EnemiesInRangeResult result{0, -1};
+        int nearest = query.radius * query.radius + 1;
+        for (const auto& enemy : enemies) {
+            int dx = enemy.x - query.x, dy = enemy.y - query.y;
+            int distance = dx * dx + dy * dy;
+            if (distance <= query.radius * query.radius) {
+                ++result.count;
+                if (distance < nearest) {
+                    nearest = distance;
+                    result.nearestEnemyID = enemy.enemyID;
+                }
+            }
+        }
+        return result;
+    });
+    auto inRange = gameEventBus.query<EnemiesInRangeQuery, EnemiesInRangeResult>({15, 25, 30});
+    std::cout << "[AI] " << inRange.count << " enemies in range, nearest is " << inRange.nearestEnemyID << std::endl;
+
+    // The asynchronous form is answered later, when the bus's thread processes queries.
+    auto farAway = gameEventBus.queryAsync<EnemiesInRangeQuery, EnemiesInRangeResult>({90, 10, 5});
+    std::cout << "[AI] Async answer ready before processing: " << std::boolalpha << farAway.ready() << std::endl;
+    gameEventBus.processQueries();
+    std::cout << "[AI] Async answer: " << farAway.get().count << " enemy, nearest is "
+              << farAway.get().nearestEnemyID << std::endl;
+
+    std::cout << std::endl;
+
+    // --- Mailbox Example ---
+    // The AI system owns its state and processes events on its own thread: the main
+    // thread's emit only drops them into the AI's mailbox.
+    std::cout << "--- Mailboxes ---" << std::endl;
+    Mailbox aiMailbox;
+    int aiEnemiesTracked = 0; // Touched only by the AI thread.
+    gameEventBus.setLogging(false);
+    gameEventBus.subscribe<EnemySpawnedEvent>(aiMailbox, [&aiEnemiesTracked](const EnemySpawnedEvent& event) {
+        ++aiEnemiesTracked;
+        std::cout << "[AI thread] Tracking " << event.type << " #" << event.enemyID << std::endl;
+    });
+    gameEventBus.emit(EnemySpawnedEvent{106, 40.0f, "Goblin"});
+    gameEventBus.emit(EnemySpawnedEvent{107, 90.0f, "Ogre"});
+    std::cout << "Queued for the AI thread: " << aiMailbox.pending() << std::endl;
+    std::thread aiThread([&aiMailbox] { aiMailbox.drain(); });
+    aiThread.join();
+    std::cout << "AI is tracking " << aiEnemiesTracked << " enemies." << std::endl;
+
+    std::cout << std::endl;
+
+    // --- Backpressure Example ---
+    // The UI only cares about the latest position, so it subscribes with a window of
+    // one credit and coalesces anything beyond that into the newest event.
+    std::cout << "--- Backpressure ---" << std::endl;
+    Mailbox uiMailbox;
+    gameEventBus.subscribe<PlayerMovedEvent>(uiMailbox, [](const PlayerMovedEvent& event) {
+        std::cout << "[UI thread] Draw " << event.playerName << " at (" << event.x << ", " << event.y << ")" << std::endl;
+    }, DeliveryPolicy::every(), Backpressure::coalesce(1));
+    for (int step = 1; step <= 5; ++step) {
+        EmitResult result = gameEventBus.emit(PlayerMovedEvent{step * 10, step * 10, "Hero"});
+        if (result.saturated()) {
+            std::cout << "Move " << step << ": UI is saturated, update coalesced." << std::endl;
+        }
+    }
+    std::thread uiThread([&uiMailbox] { uiMailbox.drain(); });
+    uiThread.join();
+    for (const auto& stats : uiMailbox.stats()) {
+        std::cout << "UI subscription: delivered " << stats.delivered << ", coalesced " << stats.coalesced
+                  << ", peak depth " << stats.peakDepth << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    // --- Latency Tracing Example ---
+    // With tracing on, each emit is stamped and every handler records how long the
+    // event waited for it, including the time spent queued in a mailbox.
+    std::cout << "--- Latency Tracing ---" << std::endl;
+    EventTracer::instance().enable();
+    gameEventBus.emit(EnemySpawnedEvent{108, 60.0f, "Orc"});
+    std::thread aiThreadTraced([&aiMailbox] { aiMailbox.drain(); });
+    aiThreadTraced.join();
+    EventTracer::instance().disable();
+    EventTracer::instance().printSummary(std::cout);
+
+    std::cout << std::endl;
+
+    // --- Serialization Example ---
+    // EVENT_FIELDS gives every event type a binary encoding, e.g. for saving a replay.
+    std::cout << "--- Serialization ---" << std::endl;
+    std::vector<char> replay;
+    serialize(replay, PlayerMovedEvent{70, 80, "Hero"});
+    serialize(replay, GameStateChangedEvent{"Victory"});
+    std::cout << "Encoded 2 events in " << replay.size() << " bytes." << std::endl;
+    ByteReader replayReader(replay.data(), replay.size());
+    PlayerMovedEvent replayedMove{};
+    GameStateChangedEvent replayedState;
+    if (deserialize(replayReader, replayedMove) && deserialize(replayReader, replayedState)) {
+        std::cout << "Decoded: " << replayedMove.playerName << " at (" << replayedMove.x << ", " << replayedMove.y
+                  << "), state '" << replayedState.newState << "'" << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    // --- Channels Example ---
+    // A room's HUD listens to its own room only; the minimap listens to players in
+    // every room through a wildcard.
+    std::cout << "--- Channels ---" << std::endl;
+    ChannelBus roomChannels;
+    roomChannels.subscribe<PlayerMovedEvent>("room/12/player", [](const PlayerMovedEvent& event) {
+        std::cout << "[Room 12 HUD] " << event.playerName << " moved to (" << event.x << ", " << event.y << ")" << std::endl;
+    });
+    roomChannels.subscribe<PlayerMovedEvent>("room/*/player", [](const PlayerMovedEvent& event) {
+        std::cout << "[Minimap] " << event.playerName << " at (" << event.x << ", " << event.y << ")" << std::endl;
+    });
+    roomChannels.emit("room/12/player", PlayerMovedEvent{5, 6, "Hero"});
+    roomChannels.emit("room/7/player", PlayerMovedEvent{1, 2, "Rogue"});
+
+#if defined(__linux__)
+    std::cout << std::endl;
+
+    // --- Event Bridge Example ---
+    // A second bus (standing in for another process) receives enemy spawns over a
+    // Unix domain socket.
+    std::cout << "--- Event Bridge ---" << std::endl;
+    EventBus inspectorBus;
+    inspectorBus.setLogging(false);
+    inspectorBus.subscribe<EnemySpawnedEvent>([](const EnemySpawnedEvent& event) {
+        std::cout << "[Inspector] Received " << event.type << " #" << event.enemyID << std::endl;
+    });
+    const std::string bridgePath = (std::filesystem::temp_directory_path() / "event_bus_demo.sock").string();
+    auto inspector = EventBridgeReceiver::listenUnix(inspectorBus, bridgePath);
+    inspector->accept<EnemySpawnedEvent>();
+    {
+        auto bridge = EventBridgeSender::connectUnix(bridgePath);
+        bridge->forward<EnemySpawnedEvent>(gameEventBus);
+        gameEventBus.emit(EnemySpawnedEvent{109, 75.0f, "Troll"});
+        bridge->flush();
+    }
+    for (int attempt = 0; attempt < 10 && inspector->receivedCount() == 0; ++attempt) {
+        inspector->poll(100);
+    }
+
+    std::cout << std::endl;
+
+    // --- Event Journal Example ---
+    // A session journals its spawns and snapshots the roster; the next session
+    // restores the roster from the snapshot plus the events journaled after it.
+    std::cout << "--- Event Journal ---" << std::endl;
+    const auto journalDirectory = std::filesystem::temp_directory_path() / "event_bus_demo_journal";
+    std::filesystem::remove_all(journalDirectory);
+    auto trackRoster = [](EventBus& bus, EnemyRoster& roster) {
+        bus.subscribe<EnemySpawnedEvent>([&roster](const EnemySpawnedEvent& event) {
+            roster.enemyIDs.push_back(event.enemyID);
+            roster.types.push_back(event.type);
+        });
+    };
+    {
+        EventBus session;
+        session.setLogging(false);
+        EnemyRoster roster;
+        trackRoster(session, roster);
+        EventJournal journal(journalDirectory);
+        journal.record<EnemySpawnedEvent>(session);
+        session.emit(EnemySpawnedEvent{110, 50.0f, "Goblin"});
+        session.emit(EnemySpawnedEvent{111, 50.0f, "Goblin"});
+        journal.snapshot(roster);
+        session.emit(EnemySpawnedEvent{112, 120.0f, "Ogre"});
+    }
+    {
+        EventBus session;
+        session.setLogging(false);
+        EnemyRoster roster;
+        EventJournal journal(journalDirectory);
+        journal.replay<EnemySpawnedEvent>();
+        trackRoster(session, roster);
+        std::uint64_t replayed = journal.restore(roster, session);
+        std::cout << "Restored " << roster.enemyIDs.size() << " enemies (" << replayed << " replayed after the snapshot)."
+                  << std::endl;
+    }
+    std::filesystem::remove_all(journalDirectory);
+#endif
+
     std::cout << std::endl << "--- Example Finished ---" << std::endl;
 
     return 0;